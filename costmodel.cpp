@@ -0,0 +1,180 @@
+#include "costmodel.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+#define PRIOR_STRENGTH 1.0
+#define FORGET_FACTOR 0.999
+#define MIN_COST 0.001
+#define PRIOR_HIT_OBJECTS_PER_MIB 10.0 // in thousands
+
+// used until there are enough observations: a bit of fixed overhead plus time per hit object
+static const double priorWeights[NUM_COST_FEATURES] = {0.01, 0.0, 0.05};
+
+static void FeatureVector(const MapCostFeatures &features, double x[NUM_COST_FEATURES])
+{
+    x[0] = 1;
+    x[1] = features.fileSize;
+    x[2] = features.hitObjects;
+}
+
+CostModel::CostModel() :
+    fileSizeSum(0),
+    hitObjectsSum(0)
+{
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+    {
+        for(int j = 0; j < NUM_COST_FEATURES; j++)
+            xtx[i][j] = 0;
+        xty[i] = 0;
+        weights[i] = priorWeights[i];
+    }
+}
+
+void CostModel::Load(const QString &filePath)
+{
+    QSettings config(filePath, QSettings::IniFormat);
+    QStringList savedXtx = config.value("CostModel/xtx").toStringList();
+    QStringList savedXty = config.value("CostModel/xty").toStringList();
+    QStringList savedDensity = config.value("CostModel/density").toStringList();
+    if(savedDensity.size() == 2)
+    {
+        fileSizeSum = savedDensity[0].toDouble();
+        hitObjectsSum = savedDensity[1].toDouble();
+    }
+    if(savedXtx.size() != NUM_COST_FEATURES * NUM_COST_FEATURES || savedXty.size() != NUM_COST_FEATURES)
+        return;
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+    {
+        for(int j = 0; j < NUM_COST_FEATURES; j++)
+            xtx[i][j] = savedXtx[i * NUM_COST_FEATURES + j].toDouble();
+        xty[i] = savedXty[i].toDouble();
+    }
+    Solve();
+}
+
+void CostModel::Save(const QString &filePath) const
+{
+    QSettings config(filePath, QSettings::IniFormat);
+    QStringList savedXtx, savedXty;
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+    {
+        for(int j = 0; j < NUM_COST_FEATURES; j++)
+            savedXtx << QString::number(xtx[i][j], 'g', 17);
+        savedXty << QString::number(xty[i], 'g', 17);
+    }
+    config.setValue("CostModel/xtx", savedXtx);
+    config.setValue("CostModel/xty", savedXty);
+    config.setValue("CostModel/density", QStringList() << QString::number(fileSizeSum, 'g', 17) << QString::number(hitObjectsSum, 'g', 17));
+    config.sync();
+}
+
+double CostModel::FileSize(const QString &mapFileName)
+{
+    return static_cast<double>(QFileInfo(mapFileName).size()) / (1 << 20);
+}
+
+MapCostFeatures CostModel::EstimateFeatures(double fileSize) const
+{
+    MapCostFeatures features;
+    features.fileSize = fileSize;
+    // one MiB of prior observation keeps the first guesses sensible
+    features.hitObjects = features.fileSize * (hitObjectsSum + PRIOR_HIT_OBJECTS_PER_MIB) / (fileSizeSum + 1);
+    return features;
+}
+
+MapCostFeatures CostModel::ReadFeatures(const QString &mapFileName)
+{
+    MapCostFeatures features = {0, 0};
+    QFile file(mapFileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return features;
+    qint64 size = file.size();
+    features.fileSize = static_cast<double>(size) / (1 << 20);
+
+    QByteArray contents;
+    const char *begin = reinterpret_cast<const char*>(file.map(0, size));
+    if(!begin)
+    {
+        contents = file.readAll();
+        begin = contents.constData();
+        size = contents.size();
+    }
+    const char *end = begin + size;
+    // every line after the section header is one hit object
+    static const char section[] = "[HitObjects]";
+    const char *hitObjects = std::search(begin, end, section, section + sizeof(section) - 1);
+    if(hitObjects != end)
+        features.hitObjects = static_cast<double>(std::count(hitObjects, end, '\n')) / 1000;
+    return features;
+}
+
+double CostModel::Predict(const MapCostFeatures &features) const
+{
+    double x[NUM_COST_FEATURES];
+    FeatureVector(features, x);
+    double cost = 0;
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+        cost += weights[i] * x[i];
+    return std::max(cost, MIN_COST);
+}
+
+void CostModel::Observe(const MapCostFeatures &features, double seconds)
+{
+    double x[NUM_COST_FEATURES];
+    FeatureVector(features, x);
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+    {
+        for(int j = 0; j < NUM_COST_FEATURES; j++)
+            xtx[i][j] = xtx[i][j] * FORGET_FACTOR + x[i] * x[j];
+        xty[i] = xty[i] * FORGET_FACTOR + x[i] * seconds;
+    }
+    fileSizeSum = fileSizeSum * FORGET_FACTOR + features.fileSize;
+    hitObjectsSum = hitObjectsSum * FORGET_FACTOR + features.hitObjects;
+    Solve();
+}
+
+void CostModel::Solve()
+{
+    // (prior * I + X'X) w = prior * w0 + X'y, gaussian elimination with partial pivoting
+    double a[NUM_COST_FEATURES][NUM_COST_FEATURES + 1];
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+    {
+        for(int j = 0; j < NUM_COST_FEATURES; j++)
+            a[i][j] = xtx[i][j] + (i == j ? PRIOR_STRENGTH : 0);
+        a[i][NUM_COST_FEATURES] = xty[i] + PRIOR_STRENGTH * priorWeights[i];
+    }
+    for(int col = 0; col < NUM_COST_FEATURES; col++)
+    {
+        int pivot = col;
+        for(int row = col + 1; row < NUM_COST_FEATURES; row++)
+        {
+            if(std::fabs(a[row][col]) > std::fabs(a[pivot][col]))
+                pivot = row;
+        }
+        if(std::fabs(a[pivot][col]) < 1e-12) // can't happen with the prior, keep the old fit anyway
+            return;
+        for(int j = 0; j <= NUM_COST_FEATURES; j++)
+            std::swap(a[col][j], a[pivot][j]);
+        for(int row = col + 1; row < NUM_COST_FEATURES; row++)
+        {
+            double factor = a[row][col] / a[col][col];
+            for(int j = col; j <= NUM_COST_FEATURES; j++)
+                a[row][j] -= factor * a[col][j];
+        }
+    }
+    double solved[NUM_COST_FEATURES];
+    for(int i = NUM_COST_FEATURES - 1; i >= 0; i--)
+    {
+        double val = a[i][NUM_COST_FEATURES];
+        for(int j = i + 1; j < NUM_COST_FEATURES; j++)
+            val -= a[i][j] * solved[j];
+        solved[i] = val / a[i][i];
+    }
+    // every feature only adds time, a negative weight from noisy timings would make bigger maps look faster
+    for(int i = 0; i < NUM_COST_FEATURES; i++)
+        weights[i] = std::max(solved[i], 0.0);
+}
@@ -0,0 +1,41 @@
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+
+#include <QString>
+
+#define NUM_COST_FEATURES 3
+
+struct MapCostFeatures
+{
+    double fileSize;   // in MiB
+    double hitObjects; // in thousands
+};
+
+// Predicts how long a map takes to calculate with a linear model over cheap features, for the ETA.
+// It is fitted by least squares on observed timings with the weights kept non-negative,
+// older observations slowly fade out, and the fit is kept between runs.
+class CostModel
+{
+public:
+    CostModel();
+    void Load(const QString &filePath);
+    void Save(const QString &filePath) const;
+
+    static double FileSize(const QString &mapFileName); // in MiB
+    // the hit objects are guessed from the density seen so far
+    MapCostFeatures EstimateFeatures(double fileSize) const;
+    static MapCostFeatures ReadFeatures(const QString &mapFileName);
+    double Predict(const MapCostFeatures &features) const; // in seconds
+    void Observe(const MapCostFeatures &features, double seconds);
+
+private:
+    double xtx[NUM_COST_FEATURES][NUM_COST_FEATURES];
+    double xty[NUM_COST_FEATURES];
+    double weights[NUM_COST_FEATURES];
+    double fileSizeSum;
+    double hitObjectsSum;
+
+    void Solve();
+};
+
+#endif // COSTMODEL_H
@@ -1,21 +1,31 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "costmodel.h"
+#include "resultexport.h"
+#include "resultstore.h"
+#include "resulttablemodel.h"
 #include <QDesktopServices>
 #include <QDirIterator>
+#include <QDoubleSpinBox>
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QHeaderView>
 #include <QLibrary>
 #include <QMessageBox>
 #include <QProgressBar>
 #include <QSettings>
-#include <QStandardItemModel>
+#include <QTableWidget>
 #include <QTextStream>
 #include <QThread>
 
-static std::vector<std::vector<RankingRawData>> rankingRawCurrent(NUM_SKILLS, std::vector<RankingRawData>());
-static std::vector<std::vector<RankingRawData>> rankingRawPrevious(NUM_SKILLS, std::vector<RankingRawData>());
-static std::vector<std::vector<RankingShowData>> rankingShow(NUM_SKILLS, std::vector<RankingShowData>());
 static QString configPath;
-static std::vector<BeatmapData> beatmapSkills;
+static QString costModelPath;
+static QString guiConfigPath;
+static double overallWeights[NUM_SKILLS];
+// results of the last two runs, rankings compare the current one to the previous one
+static RunResults runResults[NUM_KEPT_RUNS];
+static RunResults *currentRun = &runResults[0];
+static RunResults *previousRun = &runResults[1];
 typedef int (*FPNTR)(std::string, int&, int&, int mods, Skills &skills, std::string &name, double &ar, double &cs);
 static FPNTR CalculateBeatmapSkills;
 
@@ -45,13 +55,49 @@ MainWindow::MainWindow(QWidget *parent) :
         QMessageBox::critical(this, tr("osuSkillsGUI"), tr("Could not find ReloadFormulaVars in dll ") + dllPath);
 
     configPath = QDir::currentPath()+"/config.cfg";
+    costModelPath = QDir::currentPath()+"/costmodel.cfg";
+    guiConfigPath = QDir::currentPath()+"/osuSkillsGUI.cfg";
+
+    QSettings guiConfig(guiConfigPath, QSettings::IniFormat);
+    // heap for all results together, including the table sort orders and the schedule
+    qint64 memoryBudget = guiConfig.value("ResultStore/MemoryBudgetMiB", DEFAULT_RESULT_MEMORY_BUDGET >> 20).toLongLong() << 20;
+    for(auto &run : runResults)
+        run.SetMemoryBudget(memoryBudget / NUM_KEPT_RUNS);
+    for(int i = 0; i < NUM_SKILLS; i++)
+        overallWeights[i] = guiConfig.value(QString("OverallWeights/") + SkillName(static_cast<RANKING_TYPE>(i)), 1.0).toDouble();
 
     ReloadFormulaVars();
     LoadFormulaVars();
 
-    ui->tableWidget_mapList->setColumnWidth(0,645);
-    ui->tableWidget_mapList->setColumnWidth(1,100);
+    mapListModel = new MapListModel(this);
+    ui->tableView_mapList->setModel(mapListModel);
+    ui->tableView_mapList->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    connect(ui->tableView_mapList->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+            mapListModel, SLOT(UpdateSelection(QItemSelection,QItemSelection)));
+    ui->tableView_mapList->setColumnWidth(0,645);
+    ui->tableView_mapList->setColumnWidth(1,100);
+
+    overallModel = new ResultTableModel(VIEW_OVERALL, RANKING_STAMINA, this);
+    ui->tableView_overallTable->setModel(overallModel);
+    resultNamesModel = new ResultTableModel(VIEW_MAP_NAMES, RANKING_STAMINA, this);
+    ui->comboBox->setModel(resultNamesModel);
+    for(int i = 0; i < NUM_SKILLS; i++)
+        rankingModels[i] = new ResultTableModel(VIEW_RANKING, static_cast<RANKING_TYPE>(i), this);
+
+    // weight boxes go between the label and the spacer
+    for(int i = 0; i < NUM_SKILLS; i++)
+    {
+        QDoubleSpinBox *box = new QDoubleSpinBox(ui->tab_table);
+        box->setPrefix(QString(SkillName(static_cast<RANKING_TYPE>(i))).left(3) + " ");
+        box->setRange(0, 10);
+        box->setSingleStep(0.1);
+        box->setValue(overallWeights[i]);
+        ui->horizontalLayout_overallOptions->insertWidget(2 + i, box);
+        connect(box, SIGNAL(valueChanged(double)), this, SLOT(OverallWeightsChanged()));
+        overallWeightBoxes[i] = box;
+    }
     isCalculating = false;
+    threadRunning = false;
 }
 
 MainWindow::~MainWindow()
@@ -127,21 +173,11 @@ void MainWindow::on_pushButton_resetVars_clicked()
     LoadFormulaVars();
 }
 
-void MainWindow::LoadMapListTable(const std::vector<MapListItem> &fileList)
+void MainWindow::LoadMapListTable(MapList &mapList)
 {
-    ui->tableWidget_mapList->setRowCount(0);
-    for(auto &map : fileList)
-    {
-        ui->tableWidget_mapList->insertRow(ui->tableWidget_mapList->rowCount());
-        ui->tableWidget_mapList->setItem(ui->tableWidget_mapList->rowCount()-1,
-                                 0,
-                                 new QTableWidgetItem(map.fileName));
-        ui->tableWidget_mapList->setItem(ui->tableWidget_mapList->rowCount()-1,
-                                 1,
-                                 new QTableWidgetItem(map.mods));
-    }
-    this->ui->tableWidget_mapList->selectAll();
-    this->ui->tableWidget_mapList->setFocus();
+    mapListModel->SetMapList(mapList);
+    this->ui->tableView_mapList->selectAll();
+    this->ui->tableView_mapList->setFocus();
 }
 
 void MainWindow::on_pushButton_generate_clicked()
@@ -150,17 +186,10 @@ void MainWindow::on_pushButton_generate_clicked()
     if(!filePath.length())
         return;
 
-    std::string filePa = filePath.toStdString();
-    std::vector<QString> fileList;
-
     QDirIterator it(filePath, QStringList() << "*.osu", QDir::Files, QDirIterator::Subdirectories);
-    std::vector<MapListItem> mapList;
+    MapList mapList;
     while (it.hasNext())
-    {
-        QString map = it.next();
-        fileList.push_back(map);
-        mapList.push_back(MapListItem{map, ""});
-    }
+        mapList.Append(it.next(), 0);
     LoadMapListTable(mapList);
 }
 
@@ -170,36 +199,18 @@ void MainWindow::on_pushButton_load_clicked()
     if(!filePath.size())
         return;
     // load from file
-    std::vector<MapListItem> fileList;
-    QFile inputFile(filePath);
-    if (inputFile.open(QIODevice::ReadOnly))
-    {
-        QTextStream in(&inputFile);
-        while (!in.atEnd())
-        {
-            QString line = in.readLine();
-            if (!line.length())   continue;
-            if (line.contains("//")) continue; // ignore commented maps
-
-            QString mods = "";
-            QStringList tokens = line.split('\"');
-            if(tokens.size() > 1) // there are mods!
-            {
-                if(tokens[2].length())
-                    mods = tokens[2];
-                line = tokens[1];
-            }
-            fileList.push_back(MapListItem{line,mods});
-        }
-        inputFile.close();
-    }
-    else
+    MapList mapList;
+    if(!LoadMapList(filePath, mapList))
     {
         QMessageBox::critical(this, tr("osuSkillsGUI"), tr("Could not read Map List file ") + filePath);
         return;
     }
 
-    LoadMapListTable(fileList);
+    // the list is moved into the model
+    unsigned invalidModsCount = mapList.InvalidModsCount();
+    LoadMapListTable(mapList);
+    if(invalidModsCount)
+        QMessageBox::warning(this, tr("osuSkillsGUI"), QString::number(invalidModsCount) + tr(" maps have unknown mods, they were ignored"));
 }
 
 void MainWindow::on_pushButton_save_clicked()
@@ -212,8 +223,10 @@ void MainWindow::on_pushButton_save_clicked()
     if (outputFile.open(QIODevice::WriteOnly))
     {
         QTextStream out(&outputFile);
-        for(int i = 0; i < ui->tableWidget_mapList->rowCount(); i++)
-            out << "\"" << ui->tableWidget_mapList->item(i,0)->text() << "\"" << ui->tableWidget_mapList->item(i,1)->text() <<  endl;
+        out.setCodec("UTF-8");
+        const MapList &maps = mapListModel->Maps();
+        for(size_t i = 0; i < maps.Size(); i++)
+            out << "\"" << maps.Path(i) << "\"" << ModsToString(maps.Mods(i)) << '\n';
         outputFile.close();
     }
     else
@@ -225,23 +238,7 @@ void MainWindow::on_pushButton_save_clicked()
 
 void MainWindow::UpdateOverallTable()
 {
-    if(ui->tableView_overallTable->model() != nullptr)
-            ui->tableView_overallTable->model()->removeColumns(0,ui->tableView_overallTable->model()->columnCount());
-
-    QStandardItemModel *model = new QStandardItemModel(1,11,this);
-    model->setHorizontalHeaderItem(0, new QStandardItem(QString("Map")));
-    model->setHorizontalHeaderItem(1, new QStandardItem(QString("Mods")));
-    model->setHorizontalHeaderItem(2, new QStandardItem(QString("AR")));
-    model->setHorizontalHeaderItem(3, new QStandardItem(QString("CS")));
-    model->setHorizontalHeaderItem(4, new QStandardItem(QString("Sta")));
-    model->setHorizontalHeaderItem(5, new QStandardItem(QString("Ten")));
-    model->setHorizontalHeaderItem(6, new QStandardItem(QString("Agi")));
-    model->setHorizontalHeaderItem(7, new QStandardItem(QString("Acc")));
-    model->setHorizontalHeaderItem(8, new QStandardItem(QString("Pre")));
-    model->setHorizontalHeaderItem(9, new QStandardItem(QString("Reac")));
-    model->setHorizontalHeaderItem(10, new QStandardItem(QString("Mem")));
-    model->setRowCount(static_cast<int>(beatmapSkills.size()));
-    ui->tableView_overallTable->setModel(model);
+    overallModel->SetResults(currentRun, previousRun);
     ui->tableView_overallTable->setColumnWidth(0, 350);
     ui->tableView_overallTable->setColumnWidth(1, 100);
     ui->tableView_overallTable->setColumnWidth(2, 20);
@@ -250,114 +247,14 @@ void MainWindow::UpdateOverallTable()
     {
         ui->tableView_overallTable->setColumnWidth(i, 40);
     }
-    int rowIndex = 0;
-    for(auto &map : beatmapSkills)
-    {
-        model->setItem(rowIndex, 0, new QStandardItem(map.name));
-        model->setItem(rowIndex, 1, new QStandardItem(map.mods));
-        QStandardItem *item = new QStandardItem();
-        item->setData(QString::number(map.ar, 'g', 2), Qt::DisplayRole);
-        model->setItem(rowIndex, 2, item);
-        item = new QStandardItem();
-        item->setData(QString::number(map.cs, 'g', 2), Qt::DisplayRole);
-        model->setItem(rowIndex, 3, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.stamina), Qt::DisplayRole);
-        model->setItem(rowIndex, 4, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.tenacity), Qt::DisplayRole);
-        model->setItem(rowIndex, 5, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.agility), Qt::DisplayRole);
-        model->setItem(rowIndex, 6, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.accuracy), Qt::DisplayRole);
-        model->setItem(rowIndex, 7, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.precision), Qt::DisplayRole);
-        model->setItem(rowIndex, 8, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.reaction), Qt::DisplayRole);
-        model->setItem(rowIndex, 9, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(map.skills.memory), Qt::DisplayRole);
-        model->setItem(rowIndex, 10, item);
-        rowIndex++;
-    }
+    ui->tableView_overallTable->setColumnWidth(11, 50);
     ui->tableView_overallTable->setSortingEnabled(true);
 }
 
 void MainWindow::UpdateRankings()
 {
-    for (unsigned i = 0; i < rankingRawCurrent.size(); i++)
-    {
-            rankingRawCurrent[i].clear();
-            rankingShow[i].clear();
-    }
-
-    for(auto &map : beatmapSkills)
-    {
-        RankingRawData data;
-        data.name = map.name.toStdString();
-        data.mods = map.mods.toStdString();
-        data.ar = map.ar;
-        data.cs = map.cs;
-        data.val = map.skills.stamina;
-        rankingRawCurrent.at(RANKING_STAMINA).push_back(data);
-        data.val = map.skills.tenacity;
-        rankingRawCurrent.at(RANKING_TENACITY).push_back(data);
-        data.val = map.skills.agility;
-        rankingRawCurrent.at(RANKING_AGILITY).push_back(data);
-        data.val = map.skills.accuracy;
-        rankingRawCurrent.at(RANKING_ACCURACY).push_back(data);
-        data.val = map.skills.precision;
-        rankingRawCurrent.at(RANKING_PRECISION).push_back(data);
-        data.val = map.skills.reaction;
-        rankingRawCurrent.at(RANKING_REACTION).push_back(data);
-        data.val = map.skills.memory;
-        rankingRawCurrent.at(RANKING_MEMORY).push_back(data);
-    }
-
-    for (unsigned type = 0; type < rankingRawCurrent.size(); type++)
-    {
-        std::sort(rankingRawCurrent[type].rbegin(), rankingRawCurrent[type].rend()); // for quicker chart making
-        for (unsigned i = 0; i < rankingRawCurrent[type].size(); i++)
-        {
-            RankingRawData record = rankingRawCurrent[type][i];
-            std::string changeStr;
-            for (unsigned j = 0; j < rankingRawPrevious[type].size(); j++)
-            {
-                if (!rankingRawPrevious[type][j].name.compare(0, record.name.length(), record.name) && !rankingRawPrevious[type][j].mods.compare(0, record.mods.length(), record.mods))
-                {
-                    int changeRank = 0;
-                    double changeVal = 0;
-                    std::string sign = "";
-                    changeRank = static_cast<int>(j) - static_cast<int>(i);
-                    if (changeRank >= 0)
-                        sign = "+";
-                    changeRank = abs(changeRank);
-                    changeStr = sign + std::to_string(changeRank);
-                    changeVal = record.val - rankingRawPrevious[type][j].val;
-                    if (changeVal >= 0)
-                        sign = "+";
-                    else
-                        sign ="";
-                    changeStr = "(" + sign + std::to_string(static_cast<int>(changeVal)) + ") " + changeStr;
-                    break;
-                }
-            }
-            RankingShowData show;
-            show.val = record.val;
-            show.name = record.name;
-            show.change = tr(changeStr.c_str());
-            show.mods = record.mods;
-            show.ar = record.ar;
-            show.cs = record.cs;
-            rankingShow.at(type).push_back(show);
-            //logFile << record.val << "\t[" << sign << change << "]\t(" << record.cs << " CS)\t(" << record.ar << " AR)\t" << record.name << endl;
-        }
-        rankingRawPrevious[type] = rankingRawCurrent[type];
-    }
+    currentRun->UpdateDerived(previousRun, overallWeights);
+    previousRun->ReleaseAggregates();
 }
 
 void CalcThread::Stop()
@@ -367,202 +264,255 @@ void CalcThread::Stop()
 
 void CalcThread::Calculate()
 {
-    unsigned totalSelectedMaps = static_cast<unsigned>(maps.size());
-    int countProcessed = 0;
-    for (unsigned i = 0; i < totalSelectedMaps; i++)
+    // globs and directories are only expanded now, paths stay in the list's UTF-8 pool until a map is calculated
+    MapList workList;
+    ExpandMapList(maps, workList, stop);
+    MapList().Swap(maps);
+    unsigned totalSelectedMaps = static_cast<unsigned>(workList.Size());
+
+    // biggest files first so a marathon doesn't end up as the last one,
+    // the cost model only turns the sizes into the time left
+    CostModel costModel;
+    costModel.Load(costModelFile);
+    // the model keeps learning during the run, first estimates are redone with the starting fit
+    const CostModel estimateModel = costModel;
+    // 8 bytes per map from the run's budget, the features are read again when a map is calculated
+    Column<float> fileSizes;
+    Column<quint32> order;
+    fileSizes.Allocate(totalSelectedMaps, results->budget);
+    order.Allocate(totalSelectedMaps, results->budget);
+    double totalPredictedCost = 0;
+    // only the file sizes are read here, the maps are opened one by one when they are calculated
+    emit progressText(tr("Estimating map lengths"));
+    emit progressMaximum(static_cast<int>(totalSelectedMaps));
+    for (unsigned i = 0; i < totalSelectedMaps && !stop; i++)
+    {
+        fileSizes[i] = static_cast<float>(CostModel::FileSize(workList.Path(i)));
+        totalPredictedCost += estimateModel.Predict(estimateModel.EstimateFeatures(fileSizes[i]));
+        order[i] = i;
+        if(!(i % ESTIMATE_PROGRESS_INTERVAL))
+            emit progress(static_cast<int>(i));
+    }
+    if(!stop) // ties keep the list order
+        std::sort(order.Data(), order.Data() + totalSelectedMaps, [&fileSizes](quint32 a, quint32 b) { return fileSizes[a] != fileSizes[b] ? fileSizes[a] > fileSizes[b] : a < b; });
+
+    // progress is the share of the predicted time that is done
+    emit progressMaximum(PROGRESS_STEPS);
+    QElapsedTimer runTimer, mapTimer;
+    runTimer.start();
+    double donePredictedCost = 0;
+    for (unsigned k = 0; k < totalSelectedMaps; k++)
     {
         if(stop)
             break;
-        QString mapFileName = maps[i].first;
-        QString modString = maps[i].second;
-        int mods = 0;
-        if (modString.length()) // there are some mods here probably!
-        {
-            QStringList tokensMods = modString.split(" +");
-            if (tokensMods.size())
-            {
-                for (auto mod : tokensMods)
-                {
-                    if (!QString::compare(mod, "EZ", Qt::CaseInsensitive))
-                        mods += MODS::EZ;
-                    if (!QString::compare(mod, "HT", Qt::CaseInsensitive))
-                        mods += MODS::HT;
-                    if (!QString::compare(mod, "HR", Qt::CaseInsensitive))
-                        mods += MODS::HR;
-                    if (!QString::compare(mod, "DT", Qt::CaseInsensitive))
-                        mods += MODS::DT;
-                    if (!QString::compare(mod, "HD", Qt::CaseInsensitive))
-                        mods += MODS::HD;
-                    if (!QString::compare(mod, "FL", Qt::CaseInsensitive))
-                        mods += MODS::FL;
-                }
-            }
-        }
+        unsigned i = order[k];
+        QString mapFileName = workList.Path(i);
+        int mods = workList.Mods(i) & CALC_MODS;
         Skills skills;
         int unused = 0;
         double ar, cs;
 
         emit progressText(mapFileName);
+        // refine the estimate with the hit objects, the file is about to be read anyway
+        MapCostFeatures features = CostModel::ReadFeatures(mapFileName);
+        double refinedCost = costModel.Predict(features);
+        totalPredictedCost += refinedCost - estimateModel.Predict(estimateModel.EstimateFeatures(fileSizes[i]));
         std::string beatmapName;
+        mapTimer.start();
         int res = CalculateBeatmapSkills(mapFileName.toStdString(), unused, unused, mods, skills, beatmapName, ar, cs);
         if(res) // if calc is successful
         {
-            BeatmapData beatmapData;
-            beatmapData.name = tr(beatmapName.c_str());
-            beatmapData.skills = skills;
-            beatmapData.mods = modString;
-            beatmapData.ar = ar;
-            beatmapData.cs = cs;
-            beatmapSkills.push_back(beatmapData);            
+            costModel.Observe(features, mapTimer.nsecsElapsed() / 1e9);
+            results->store.Append(tr(beatmapName.c_str()), workList.Mods(i), ar, cs, skills);
         }
-        countProcessed++;
-        emit progress(countProcessed);
+        donePredictedCost += refinedCost;
+        emit progress(static_cast<int>(PROGRESS_STEPS * donePredictedCost / totalPredictedCost));
+        // the rest of the predictions are scaled by how far off they were so far
+        double secondsLeft = (totalPredictedCost - donePredictedCost) * (runTimer.elapsed() / 1000.0) / donePredictedCost;
+        emit timeLeft(static_cast<int>(secondsLeft + 0.5));
     }
+    costModel.Save(costModelFile);
     this->thread()->quit();
 }
 
 void MainWindow::UpdateAll()
 {
+    threadRunning = false;
+    ui->pushButton_calculate->setEnabled(true);
     ui->label_mapProcessingName->setText("none");
 
-    for(unsigned i = 0; i < beatmapSkills.size(); i++)
-    {
-        BeatmapData *map = &beatmapSkills[i];
-        ui->comboBox->addItem(map->name + map->mods);
-    }
-    UpdateOverallTable();
+    resultNamesModel->SetResults(currentRun, previousRun);
+    // a model reset leaves the combo box without a current item
+    ui->comboBox->setCurrentIndex(resultNamesModel->rowCount() ? 0 : -1);
+    if(ui->comboBox->currentIndex() < 0)
+        on_comboBox_currentIndexChanged(-1);
     UpdateRankings();
+    UpdateOverallTable();
+    ui->progressBar->setFormat("%p%");
     ui->pushButton_calculate->setText("Calculate");
     isCalculating = false;
     ui->label_mapProcessingName->setText("none");
 }
 
+void MainWindow::UpdateTimeLeft(int seconds)
+{
+    if(!isCalculating)
+        return;
+    ui->progressBar->setFormat(QString("%p% (%1:%2 left)").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0')));
+}
+
 void MainWindow::on_pushButton_calculate_clicked()
 {
     if(isCalculating)
     {
         worker->Stop();
         ui->pushButton_calculate->setText("Calculate");
+        ui->pushButton_calculate->setEnabled(false); // until the worker is done with its current map
         isCalculating = false;
         ui->label_mapProcessingName->setText("none");
         return;
     }
-    if(!ui->tableWidget_mapList->rowCount())
+    if(threadRunning || !mapListModel->rowCount())
         return;
 
     SaveFormulaVars();
     ReloadFormulaVars();
 
+    // the tables must let go of the rows before the older run is cleared
+    overallModel->SetResults(nullptr, nullptr);
+    resultNamesModel->SetResults(nullptr, nullptr);
     for(int i = 0; i < NUM_SKILLS; i++)
-        rankingCreated[i] = false;
-    ui->comboBox->clear();
-    beatmapSkills.clear();
-
-    std::vector<std::pair<QString, QString>> maps;
-    for (int i = 0; i < ui->tableWidget_mapList->rowCount(); i++)
     {
-        QTableWidgetItem *mapNameItem = ui->tableWidget_mapList->item(i,0);
-        if(!mapNameItem->isSelected())
-            continue;
-        std::pair<QString, QString> map;
-        map.first = mapNameItem->text();
-        QTableWidgetItem *modsItem = ui->tableWidget_mapList->item(i,1);
-        map.second = modsItem->text();
-        maps.push_back(map);
+        rankingCreated[i] = false;
+        rankingModels[i]->SetResults(nullptr, nullptr);
     }
+    std::swap(currentRun, previousRun);
+    currentRun->Clear();
 
-    ui->progressBar->setRange(0, static_cast<int>(maps.size()));
+    MapList maps = mapListModel->SelectedMaps();
+
+    ui->progressBar->setRange(0, 0); // busy until the list is expanded
 
     QThread *thread = new QThread(this);
     worker = new CalcThread;
     worker->moveToThread(thread);
-    worker->maps = maps;
+    worker->maps.Swap(maps);
+    worker->results = currentRun;
+    worker->costModelFile = costModelPath;
 
     connect(thread, SIGNAL(finished()), worker, SLOT(deleteLater()));
     connect(thread, SIGNAL(finished()), this, SLOT(UpdateAll()));
     connect(thread, SIGNAL(started()), worker, SLOT(Calculate()));
 
+    connect(worker, SIGNAL(progressMaximum(int)), ui->progressBar, SLOT(setMaximum(int)));
     connect(worker, SIGNAL(progress(int)), ui->progressBar, SLOT(setValue(int)));
     connect(worker, SIGNAL(progressText(QString)), ui->label_mapProcessingName, SLOT(setText(QString)));
+    connect(worker, SIGNAL(timeLeft(int)), this, SLOT(UpdateTimeLeft(int)));
     thread->start();
 
     isCalculating = true;
+    threadRunning = true;
     ui->pushButton_calculate->setText("Stop");
 }
 
+void MainWindow::on_pushButton_export_clicked()
+{
+    // the worker appends to the store until its thread is done, even after Stop
+    if(threadRunning || !currentRun->store.Size())
+        return;
+
+    QString csvFilter = tr("CSV (*.csv)");
+    QString jsonlFilter = tr("JSON Lines (*.jsonl)");
+    QString columnarFilter = tr("Binary columnar (*.oskc)");
+    QString selectedFilter;
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export results"), QDir::currentPath(),
+                                                    csvFilter + ";;" + jsonlFilter + ";;" + columnarFilter, &selectedFilter);
+    if(!filePath.size())
+        return;
+
+    EXPORT_FORMAT format = EXPORT_CSV;
+    QString suffix = ".csv";
+    if(selectedFilter == jsonlFilter)
+    {
+        format = EXPORT_JSONL;
+        suffix = ".jsonl";
+    }
+    else if(selectedFilter == columnarFilter)
+    {
+        format = EXPORT_COLUMNAR;
+        suffix = ".oskc";
+    }
+    if(QFileInfo(filePath).suffix().isEmpty())
+        filePath += suffix;
+
+    if(!ExportResults(filePath, format, currentRun->store))
+        QMessageBox::critical(this, tr("osuSkillsGUI"), tr("Could not export results to ") + filePath);
+}
+
 void MainWindow::on_comboBox_currentIndexChanged(int index)
 {
     int comboBoxIndex = this->ui->comboBox->currentIndex();
     if(comboBoxIndex < 0)
+    {
+        // no results, don't keep showing a map of an earlier run
+        this->ui->lineEdit_mapStamina->clear();
+        this->ui->lineEdit_mapTenacity->clear();
+        this->ui->lineEdit_mapAgility->clear();
+        this->ui->lineEdit_mapAccuracy->clear();
+        this->ui->lineEdit_mapPrecision->clear();
+        this->ui->lineEdit_mapReaction->clear();
+        this->ui->lineEdit_mapMemory->clear();
         return;
+    }
 
-    unsigned mapIndex = static_cast<unsigned>(comboBoxIndex);
-    this->ui->lineEdit_mapStamina->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.stamina)));
-    this->ui->lineEdit_mapTenacity->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.tenacity)));
-    this->ui->lineEdit_mapAgility->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.agility)));
-    this->ui->lineEdit_mapAccuracy->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.accuracy)));
-    this->ui->lineEdit_mapPrecision->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.precision)));
-    this->ui->lineEdit_mapReaction->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.reaction)));
-    this->ui->lineEdit_mapMemory->setText(QString::number(static_cast<int>(beatmapSkills[mapIndex].skills.memory)));
+    BeatmapData map = currentRun->store.At(resultNamesModel->StoreRow(comboBoxIndex));
+    this->ui->lineEdit_mapStamina->setText(QString::number(static_cast<int>(map.skills.stamina)));
+    this->ui->lineEdit_mapTenacity->setText(QString::number(static_cast<int>(map.skills.tenacity)));
+    this->ui->lineEdit_mapAgility->setText(QString::number(static_cast<int>(map.skills.agility)));
+    this->ui->lineEdit_mapAccuracy->setText(QString::number(static_cast<int>(map.skills.accuracy)));
+    this->ui->lineEdit_mapPrecision->setText(QString::number(static_cast<int>(map.skills.precision)));
+    this->ui->lineEdit_mapReaction->setText(QString::number(static_cast<int>(map.skills.reaction)));
+    this->ui->lineEdit_mapMemory->setText(QString::number(static_cast<int>(map.skills.memory)));
 }
 
 void MainWindow::on_pushButton_selectAll_clicked()
 {
-    this->ui->tableWidget_mapList->selectAll();
+    this->ui->tableView_mapList->selectAll();
 }
 
 void MainWindow::ShowRanking(RANKING_TYPE skill)
 {
-    if(rankingCreated[skill])
+    if(rankingCreated[skill] || threadRunning)
         return;
-    QString skillStr;
     QTableView *table = nullptr;
     switch(skill)
     {
         case RANKING_STAMINA:
-            skillStr = "Stamina";
             table = ui->tableView_stamina;
         break;
         case RANKING_TENACITY:
-            skillStr = "Tenacity";
             table = ui->tableView_tenacity;
         break;
         case RANKING_AGILITY:
-            skillStr = "Agility";
             table = ui->tableView_agility;
         break;
         case RANKING_ACCURACY:
-            skillStr = "Accuracy";
             table = ui->tableView_accuracy;
         break;
         case RANKING_PRECISION:
-            skillStr = "Precision";
             table = ui->tableView_precision;
         break;
         case RANKING_REACTION:
-            skillStr = "Reaction";
             table = ui->tableView_reaction;
         break;
         case RANKING_MEMORY:
-            skillStr = "Memory";
             table = ui->tableView_memory;
         break;
     }
 
-    // clearing
-    if(table->model() != nullptr)
-            table->model()->removeColumns(0,table->model()->columnCount());
-
-    QStandardItemModel *model = new QStandardItemModel(1,6,this);
-    model->setHorizontalHeaderItem(0, new QStandardItem(QString("Map")));
-    model->setHorizontalHeaderItem(1, new QStandardItem(QString("Mods")));
-    model->setHorizontalHeaderItem(2, new QStandardItem(QString("AR")));
-    model->setHorizontalHeaderItem(3, new QStandardItem(QString("CS")));
-    model->setHorizontalHeaderItem(4, new QStandardItem(skillStr));
-    model->setHorizontalHeaderItem(5, new QStandardItem(QString("Change")));
-    model->setRowCount(static_cast<int>(beatmapSkills.size()));
-    delete table->model();
-    table->setModel(model);
+    rankingModels[skill]->SetResults(currentRun, previousRun);
+    if(table->model() != rankingModels[skill])
+        table->setModel(rankingModels[skill]);
     table->setColumnWidth(0, 470);
     table->setColumnWidth(1, 100);
     table->setColumnWidth(2, 20);
@@ -570,29 +520,8 @@ void MainWindow::ShowRanking(RANKING_TYPE skill)
     table->setColumnWidth(4, 60);
     table->setColumnWidth(5, 80);
 
-    int rowIndex = 0;
-    for (unsigned i = 0; i < rankingShow[skill].size(); i++)
-    {
-        RankingShowData data = rankingShow[skill][i];
-        model->setItem(rowIndex, 0, new QStandardItem(data.name.c_str()));
-        model->setItem(rowIndex, 1, new QStandardItem(data.mods.c_str()));
-        QStandardItem *item = new QStandardItem();        
-        item->setData(QString::number(data.ar, 'g', 2), Qt::DisplayRole);
-        model->setItem(rowIndex, 2, item);
-        item = new QStandardItem();
-        item->setData(QString::number(data.cs, 'g', 2), Qt::DisplayRole);
-        model->setItem(rowIndex, 3, item);
-        item = new QStandardItem();
-        item->setData(static_cast<int>(data.val), Qt::DisplayRole);
-        model->setItem(rowIndex, 4, item);
-        QStandardItem *changeItem = new QStandardItem(data.change);
-        changeItem->setToolTip("(+points) +rank");
-        model->setItem(rowIndex, 5, changeItem);
-
-        rowIndex++;
-    }
-
-    table->sortByColumn(4, Qt::SortOrder::DescendingOrder);
+    // rows already come in the run's ranking order, the model doesn't sort again for this indicator
+    table->horizontalHeader()->setSortIndicator(4, Qt::DescendingOrder);
     table->setSortingEnabled(true);
     rankingCreated[skill] = true;
 }
@@ -613,3 +542,26 @@ void MainWindow::on_textBrowser_anchorClicked(const QUrl &arg1)
 {
     QDesktopServices::openUrl(QUrl(arg1));
 }
+
+void MainWindow::on_checkBox_normalized_toggled(bool checked)
+{
+    overallModel->SetNormalized(checked);
+}
+
+void MainWindow::OverallWeightsChanged()
+{
+    QSettings guiConfig(guiConfigPath, QSettings::IniFormat);
+    for(int i = 0; i < NUM_SKILLS; i++)
+    {
+        overallWeights[i] = overallWeightBoxes[i]->value();
+        guiConfig.setValue(QString("OverallWeights/") + SkillName(static_cast<RANKING_TYPE>(i)), overallWeights[i]);
+    }
+    // a running calculation uses the new weights once it's done
+    if(threadRunning || !currentRun->HasAggregates())
+        return;
+    currentRun->UpdateOverall(overallWeights);
+    overallModel->OverallChanged();
+    QHeaderView *header = ui->tableView_overallTable->horizontalHeader();
+    if(header->sortIndicatorSection() == header->count() - 1)
+        overallModel->sort(header->sortIndicatorSection(), header->sortIndicatorOrder());
+}
@@ -3,6 +3,8 @@
 
 #include <QMainWindow>
 #include <QLibrary>
+#include "maplist.h"
+#include "maplistmodel.h"
 
 namespace Ui {
 
@@ -10,26 +12,8 @@ class MainWindow;
 }
 
 #define NUM_SKILLS 7
-
-struct RankingRawData
-{
-    std::string name;
-    std::string mods;
-    double ar;
-    double cs;
-    double val;
-    bool operator<(const RankingRawData& other) const { return (val < other.val); }
-};
-
-struct RankingShowData
-{
-    std::string name;
-    std::string mods;
-    double ar;
-    double cs;
-    double val;
-    QString change;
-};
+#define PROGRESS_STEPS 1000
+#define ESTIMATE_PROGRESS_INTERVAL 1024
 
 struct Skills
 {
@@ -52,12 +36,6 @@ struct BeatmapData
     Skills skills;
 };
 
-struct MapListItem
-{
-    QString fileName;
-    QString mods;
-};
-
 enum RANKING_TYPE
 {
     RANKING_STAMINA,
@@ -85,7 +63,13 @@ enum MODS
     AP = 8192
 };
 
+// mods that are passed to the calculator
+#define CALC_MODS (EZ | HD | HR | DT | HT | FL)
+
 class CalcThread;
+class QDoubleSpinBox;
+class ResultTableModel;
+struct RunResults;
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -103,6 +87,8 @@ private slots:
 
     void on_pushButton_calculate_clicked();
 
+    void on_pushButton_export_clicked();
+
     void on_comboBox_currentIndexChanged(int index);
 
     void on_pushButton_selectAll_clicked();
@@ -115,18 +101,30 @@ private slots:
 
     void UpdateAll();
 
+    void UpdateTimeLeft(int seconds);
+
     void on_textBrowser_anchorClicked(const QUrl &arg1);
 
+    void on_checkBox_normalized_toggled(bool checked);
+
+    void OverallWeightsChanged();
+
 private:
     Ui::MainWindow *ui;
     QLibrary lib;
     typedef int (*FPNTR2)(void);
     FPNTR2 ReloadFormulaVars;
     CalcThread* worker;
+    MapListModel *mapListModel;
+    ResultTableModel *overallModel;
+    ResultTableModel *resultNamesModel;
+    ResultTableModel *rankingModels[NUM_SKILLS];
+    QDoubleSpinBox *overallWeightBoxes[NUM_SKILLS];
 
     bool rankingCreated[NUM_SKILLS];
     bool isCalculating;
-    void LoadMapListTable(const std::vector<MapListItem> &fileList);
+    bool threadRunning; // a stopped worker still finishes its current map, only cleared once its thread is done
+    void LoadMapListTable(MapList &mapList);
     void UpdateOverallTable();
     void UpdateRankings();
     void ShowRanking(RANKING_TYPE skill);
@@ -141,7 +139,9 @@ class CalcThread: public QObject
 public:
     CalcThread() {};
     virtual ~CalcThread() {};
-    std::vector<std::pair<QString, QString>> maps;
+    MapList maps;
+    RunResults *results = nullptr;
+    QString costModelFile;
     bool stop = false;
 
 public slots:
@@ -150,7 +150,9 @@ public slots:
 
 signals:
     void progress(int);
+    void progressMaximum(int);
     void progressText(QString);
+    void timeLeft(int);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,409 @@
+#include "maplist.h"
+#include "mainwindow.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#define MIN_CHUNK_SIZE (1 << 20)
+#define AVERAGE_LINE_LENGTH 96
+#define UTF8_MIB 106
+
+struct ModName
+{
+    char name[3];
+    int mod;
+};
+
+// also the order mods are written back in
+static const ModName modNames[] = {
+    {"NF", NF}, {"EZ", EZ}, {"HD", HD}, {"HR", HR}, {"SD", SD}, {"DT", DT},
+    {"RL", RL}, {"HT", HT}, {"FL", FL}, {"AU", AU}, {"SO", SO}, {"AP", AP}
+};
+
+void MapList::Append(const char *path, int length, int mods, bool invalidMods)
+{
+    MapListEntry entry;
+    entry.pathOffset = paths.size();
+    entry.pathLength = static_cast<quint32>(length);
+    entry.mods = static_cast<quint16>(mods);
+    entry.type = (memchr(path, '*', length) || memchr(path, '?', length)) ? ENTRY_GLOB : ENTRY_PATH;
+    entry.invalidMods = invalidMods;
+    entries.push_back(entry);
+    paths.insert(paths.end(), path, path + length);
+    if(invalidMods)
+        invalidModsCount++;
+}
+
+void MapList::Append(const QString &path, int mods, bool invalidMods)
+{
+    QByteArray utf8 = path.toUtf8();
+    Append(utf8.constData(), utf8.size(), mods, invalidMods);
+}
+
+void MapList::Append(const MapList &other, size_t index)
+{
+    const MapListEntry &entry = other.entries[index];
+    Append(other.paths.data() + entry.pathOffset, static_cast<int>(entry.pathLength), entry.mods, entry.invalidMods);
+}
+
+void MapList::SetPath(size_t index, const QString &path)
+{
+    QByteArray utf8 = path.toUtf8();
+    MapListEntry &entry = entries[index];
+    entry.pathOffset = paths.size();
+    entry.pathLength = static_cast<quint32>(utf8.size());
+    entry.type = (utf8.contains('*') || utf8.contains('?')) ? ENTRY_GLOB : ENTRY_PATH;
+    paths.insert(paths.end(), utf8.constData(), utf8.constData() + utf8.size());
+}
+
+void MapList::SetMods(size_t index, int mods)
+{
+    MapListEntry &entry = entries[index];
+    entry.mods = static_cast<quint16>(mods);
+    if(entry.invalidMods)
+        invalidModsCount--;
+    entry.invalidMods = false;
+}
+
+void MapList::Clear()
+{
+    entries.clear();
+    paths.clear();
+    invalidModsCount = 0;
+}
+
+void MapList::Reserve(size_t count, size_t pathBytes)
+{
+    entries.reserve(count);
+    paths.reserve(pathBytes);
+}
+
+QString MapList::Path(size_t index) const
+{
+    const MapListEntry &entry = entries[index];
+    return QString::fromUtf8(paths.data() + entry.pathOffset, static_cast<int>(entry.pathLength));
+}
+
+void MapList::Splice(MapList &other)
+{
+    if(!other.Size())
+        return;
+    quint64 base = paths.size();
+    entries.reserve(entries.size() + other.entries.size());
+    for(MapListEntry entry : other.entries)
+    {
+        entry.pathOffset += base;
+        entries.push_back(entry);
+    }
+    paths.insert(paths.end(), other.paths.begin(), other.paths.end());
+    invalidModsCount += other.invalidModsCount;
+    other.Clear();
+    other.entries.shrink_to_fit();
+    other.paths.shrink_to_fit();
+}
+
+void MapList::Swap(MapList &other)
+{
+    entries.swap(other.entries);
+    paths.swap(other.paths);
+    std::swap(invalidModsCount, other.invalidModsCount);
+}
+
+static bool IsModSeparator(char c)
+{
+    return c == ' ' || c == '+' || c == '\t' || c == ',';
+}
+
+int ParseMods(const char *text, int length, bool &valid)
+{
+    int mods = 0;
+    valid = true;
+    int i = 0;
+    while(i < length)
+    {
+        if(IsModSeparator(text[i]))
+        {
+            i++;
+            continue;
+        }
+        int start = i;
+        while(i < length && !IsModSeparator(text[i]))
+            i++;
+        bool found = false;
+        if(i - start == 2)
+        {
+            // ASCII upper case
+            char first = text[start] & ~0x20;
+            char second = text[start + 1] & ~0x20;
+            for(auto &mod : modNames)
+            {
+                if(mod.name[0] == first && mod.name[1] == second)
+                {
+                    mods |= mod.mod;
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if(!found)
+            valid = false;
+    }
+    return mods;
+}
+
+int ParseMods(const QString &text, bool &valid)
+{
+    QByteArray utf8 = text.toUtf8();
+    return ParseMods(utf8.constData(), utf8.size(), valid);
+}
+
+QString ModsToString(int mods)
+{
+    QString str;
+    for(auto &mod : modNames)
+    {
+        if(!(mods & mod.mod))
+            continue;
+        if(str.length())
+            str += ' ';
+        str += '+';
+        str += QLatin1String(mod.name);
+    }
+    return str;
+}
+
+static void ParseLine(const char *line, const char *lineEnd, MapList &list)
+{
+    if(lineEnd > line && lineEnd[-1] == '\r')
+        lineEnd--;
+    int length = static_cast<int>(lineEnd - line);
+    if(!length)
+        return;
+
+    // ignore commented maps
+    for(const char *slash = line; (slash = static_cast<const char*>(memchr(slash, '/', lineEnd - slash))) != nullptr; slash++)
+    {
+        if(slash + 1 < lineEnd && slash[1] == '/')
+            return;
+    }
+
+    const char *quote = static_cast<const char*>(memchr(line, '"', length));
+    if(!quote) // no mods
+    {
+        list.Append(line, length, 0);
+        return;
+    }
+    const char *path = quote + 1;
+    const char *pathEnd = static_cast<const char*>(memchr(path, '"', lineEnd - path));
+    if(!pathEnd)
+    {
+        list.Append(path, static_cast<int>(lineEnd - path), 0);
+        return;
+    }
+    const char *mods = pathEnd + 1;
+    const char *modsEnd = static_cast<const char*>(memchr(mods, '"', lineEnd - mods));
+    if(!modsEnd)
+        modsEnd = lineEnd;
+    bool valid;
+    int modsValue = ParseMods(mods, static_cast<int>(modsEnd - mods), valid);
+    list.Append(path, static_cast<int>(pathEnd - path), modsValue, !valid);
+}
+
+static void ParseLines(const char *begin, const char *end, MapList &list)
+{
+    list.Reserve(static_cast<size_t>(end - begin) / AVERAGE_LINE_LENGTH, static_cast<size_t>(end - begin));
+    while(begin < end)
+    {
+        const char *lineEnd = static_cast<const char*>(memchr(begin, '\n', end - begin));
+        if(!lineEnd)
+            lineEnd = end;
+        ParseLine(begin, lineEnd, list);
+        begin = lineEnd + 1;
+    }
+}
+
+static bool IsUtf8(const char *begin, const char *end)
+{
+    // checked in pieces so no decoded copy of the whole list is made
+    QTextCodec *codec = QTextCodec::codecForMib(UTF8_MIB);
+    QTextCodec::ConverterState state;
+    while(begin < end)
+    {
+        int length = static_cast<int>(std::min<qint64>(end - begin, MIN_CHUNK_SIZE));
+        codec->toUnicode(begin, length, &state);
+        if(state.invalidChars)
+            return false;
+        begin += length;
+    }
+    return !state.remainingChars;
+}
+
+bool LoadMapList(const QString &filePath, MapList &list)
+{
+    list.Clear();
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    qint64 size = file.size();
+    if(!size)
+        return true;
+
+    QByteArray contents;
+    const char *begin = reinterpret_cast<const char*>(file.map(0, size));
+    if(!begin) // not every file can be mapped
+    {
+        contents = file.readAll();
+        begin = contents.constData();
+        size = contents.size();
+    }
+    const char *end = begin + size;
+
+    // the parser works on UTF-8, anything else is converted first
+    QByteArray converted;
+    QTextCodec *bomCodec = QTextCodec::codecForUtfText(QByteArray::fromRawData(begin, static_cast<int>(std::min<qint64>(size, 4))), nullptr);
+    if(bomCodec && bomCodec->mibEnum() == UTF8_MIB)
+        begin += 3;
+    else if(bomCodec || !IsUtf8(begin, end))
+    {
+        // UTF-16 or UTF-32 such as Notepad's "Unicode", or the locale's codepage older versions saved lists in
+        QString text = bomCodec ? bomCodec->toUnicode(begin, static_cast<int>(size)) : QString::fromLocal8Bit(begin, static_cast<int>(size));
+        converted = text.toUtf8();
+        begin = converted.constData();
+        end = begin + converted.size();
+    }
+
+    // split at line boundaries, one chunk per core
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, static_cast<size_t>(end - begin) / MIN_CHUNK_SIZE + 1);
+    std::vector<const char*> bounds(threadCount + 1);
+    bounds[0] = begin;
+    bounds[threadCount] = end;
+    for(size_t i = 1; i < threadCount; i++)
+    {
+        const char *split = std::max(begin + (end - begin) / static_cast<qint64>(threadCount) * static_cast<qint64>(i), bounds[i - 1]);
+        const char *lineEnd = static_cast<const char*>(memchr(split, '\n', end - split));
+        bounds[i] = lineEnd ? lineEnd + 1 : end;
+    }
+
+    std::vector<MapList> chunks(threadCount);
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; i++)
+        threads.push_back(std::thread(ParseLines, bounds[i], bounds[i + 1], std::ref(chunks[i])));
+    ParseLines(bounds[0], bounds[1], chunks[0]);
+    for(auto &thread : threads)
+        thread.join();
+
+    list.Swap(chunks[0]);
+    size_t count = list.Size(), pathBytes = list.PathBytes();
+    for(size_t i = 1; i < threadCount; i++)
+    {
+        count += chunks[i].Size();
+        pathBytes += chunks[i].PathBytes();
+    }
+    list.Reserve(count, pathBytes);
+    for(size_t i = 1; i < threadCount; i++)
+        list.Splice(chunks[i]);
+    return true;
+}
+
+static bool HasWildcards(const QString &part)
+{
+    return part.contains('*') || part.contains('?');
+}
+
+static QString JoinPath(const QString &dir, const QString &name)
+{
+    return dir.endsWith('/') ? dir + name : dir + '/' + name;
+}
+
+// matches parts[index..] below dir, "**" stands for any number of directories
+static void ExpandGlobParts(const QString &dir, const QStringList &parts, int index, int mods, MapList &maps)
+{
+    const QString &part = parts[index];
+    bool last = index == parts.size() - 1;
+    if(part == "**")
+    {
+        if(last)
+        {
+            QDirIterator it(dir, QStringList() << "*.osu", QDir::Files, QDirIterator::Subdirectories);
+            while(it.hasNext())
+                maps.Append(it.next(), mods);
+            return;
+        }
+        ExpandGlobParts(dir, parts, index + 1, mods, maps);
+        QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while(it.hasNext())
+            ExpandGlobParts(it.next(), parts, index + 1, mods, maps);
+        return;
+    }
+    if(!HasWildcards(part))
+    {
+        QString path = JoinPath(dir, part);
+        QFileInfo info(path);
+        if(last && info.isFile())
+            maps.Append(path, mods);
+        else if(!last && info.isDir())
+            ExpandGlobParts(path, parts, index + 1, mods, maps);
+        return;
+    }
+    QDir::Filters filters = last ? QDir::Filters(QDir::Files) : QDir::Dirs | QDir::NoDotAndDotDot;
+    QDirIterator it(dir, QStringList() << part, filters);
+    while(it.hasNext())
+    {
+        QString path = it.next();
+        if(last)
+            maps.Append(path, mods);
+        else
+            ExpandGlobParts(path, parts, index + 1, mods, maps);
+    }
+}
+
+static void ExpandGlob(const QString &glob, int mods, MapList &maps)
+{
+    QStringList parts = QDir::fromNativeSeparators(glob).split('/');
+    // repeated "**" would list the same directories again
+    for(int i = parts.size() - 1; i > 0; i--)
+    {
+        if(parts[i] == "**" && parts[i - 1] == "**")
+            parts.removeAt(i);
+    }
+    // the part before the first wildcard is used as it is
+    int first = 0;
+    while(first < parts.size() && !HasWildcards(parts[first]))
+        first++;
+    if(first == parts.size())
+        return;
+    QString dir = first ? QStringList(parts.mid(0, first)).join('/') : QString(".");
+    if(dir.isEmpty())
+        dir = "/";
+    ExpandGlobParts(dir, parts, first, mods, maps);
+}
+
+static void ExpandDirectory(const QString &dir, int mods, MapList &maps)
+{
+    QDirIterator it(dir, QStringList() << "*.osu", QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+        maps.Append(it.next(), mods);
+}
+
+void ExpandMapList(const MapList &list, MapList &maps, const bool &stop)
+{
+    maps.Reserve(maps.Size() + list.Size(), maps.PathBytes() + list.PathBytes());
+    for(size_t i = 0; i < list.Size(); i++)
+    {
+        if(stop)
+            break;
+        QString path = list.Path(i);
+        int mods = list.Mods(i);
+        if(list.Type(i) == ENTRY_GLOB)
+            ExpandGlob(path, mods, maps);
+        else if(!path.endsWith(".osu", Qt::CaseInsensitive) && QFileInfo(path).isDir())
+            ExpandDirectory(path, mods, maps);
+        else
+            maps.Append(list, i);
+    }
+}
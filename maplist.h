@@ -0,0 +1,63 @@
+#ifndef MAPLIST_H
+#define MAPLIST_H
+
+#include <QString>
+#include <vector>
+
+enum MAP_LIST_ENTRY_TYPE
+{
+    ENTRY_PATH, // .osu file or a directory, resolved when the list is expanded
+    ENTRY_GLOB  // * and ? in any part of the path, "**" matches any number of directories
+};
+
+struct MapListEntry
+{
+    quint64 pathOffset;
+    quint32 pathLength;
+    quint16 mods;
+    quint8 type;
+    quint8 invalidMods; // line had mod tokens that were not recognized
+};
+
+// Compact list of maps: all paths are kept as UTF-8 in a single pool
+class MapList
+{
+public:
+    void Append(const char *path, int length, int mods, bool invalidMods = false);
+    void Append(const QString &path, int mods, bool invalidMods = false);
+    void Append(const MapList &other, size_t index);
+    void Clear();
+    void Reserve(size_t count, size_t pathBytes);
+
+    size_t Size() const { return entries.size(); }
+    size_t PathBytes() const { return paths.size(); }
+    QString Path(size_t index) const;
+    int Mods(size_t index) const { return entries[index].mods; }
+    MAP_LIST_ENTRY_TYPE Type(size_t index) const { return static_cast<MAP_LIST_ENTRY_TYPE>(entries[index].type); }
+    unsigned InvalidModsCount() const { return invalidModsCount; }
+
+    // the old path stays in the pool until the list is reloaded
+    void SetPath(size_t index, const QString &path);
+    void SetMods(size_t index, int mods);
+
+    // moves another list to the end of this one
+    void Splice(MapList &other);
+    void Swap(MapList &other);
+
+private:
+    std::vector<MapListEntry> entries;
+    std::vector<char> paths;
+    unsigned invalidModsCount = 0;
+};
+
+// memory-maps the file and parses it on all cores, lines are "path" or "path"+MOD +MOD
+// UTF-8 is read in place, lists with a UTF-16 BOM or in the locale's codepage are converted first
+bool LoadMapList(const QString &filePath, MapList &list);
+// replaces globs and directories with the .osu files they match, maps is appended to
+void ExpandMapList(const MapList &list, MapList &maps, const bool &stop);
+
+int ParseMods(const char *text, int length, bool &valid);
+int ParseMods(const QString &text, bool &valid);
+QString ModsToString(int mods);
+
+#endif // MAPLIST_H
@@ -0,0 +1,143 @@
+#include "maplistmodel.h"
+
+static unsigned LowestBit(quint64 word)
+{
+#ifdef __GNUC__
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned bit = 0;
+    while(!((word >> bit) & 1))
+        bit++;
+    return bit;
+#endif
+}
+
+MapListModel::MapListModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+}
+
+void MapListModel::SetMapList(MapList &mapList)
+{
+    beginResetModel();
+    maps.Swap(mapList);
+    mapList.Clear();
+    selection.assign((maps.Size() + 63) / 64, 0);
+    endResetModel();
+}
+
+size_t MapListModel::SelectedCount() const
+{
+    size_t count = 0;
+    for(quint64 word : selection)
+    {
+        // clear the lowest bit until none are left
+        for(; word; count++)
+            word &= word - 1;
+    }
+    return count;
+}
+
+MapList MapListModel::SelectedMaps() const
+{
+    MapList selected;
+    selected.Reserve(SelectedCount(), 0);
+    for(size_t i = 0; i < selection.size(); i++)
+    {
+        // visit only the set bits, lowest first
+        for(quint64 word = selection[i]; word; word &= word - 1)
+            selected.Append(maps, i * 64 + LowestBit(word));
+    }
+    return selected;
+}
+
+void MapListModel::SetSelected(size_t first, size_t last, bool selected)
+{
+    // whole words are filled at once, only the ends are done bit by bit
+    while(first <= last && first % 64)
+    {
+        if(selected)
+            selection[first / 64] |= 1ULL << (first % 64);
+        else
+            selection[first / 64] &= ~(1ULL << (first % 64));
+        first++;
+    }
+    while(first + 63 <= last)
+    {
+        selection[first / 64] = selected ? ~0ULL : 0;
+        first += 64;
+    }
+    for(; first <= last; first++)
+    {
+        if(selected)
+            selection[first / 64] |= 1ULL << (first % 64);
+        else
+            selection[first / 64] &= ~(1ULL << (first % 64));
+    }
+}
+
+void MapListModel::UpdateSelection(const QItemSelection &selected, const QItemSelection &deselected)
+{
+    for(auto &range : deselected)
+        SetSelected(static_cast<size_t>(range.top()), static_cast<size_t>(range.bottom()), false);
+    for(auto &range : selected)
+        SetSelected(static_cast<size_t>(range.top()), static_cast<size_t>(range.bottom()), true);
+}
+
+int MapListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(maps.Size());
+}
+
+int MapListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant MapListModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+        return QVariant();
+    size_t row = static_cast<size_t>(index.row());
+    if(index.column() == 0)
+        return maps.Path(row);
+    return ModsToString(maps.Mods(row));
+}
+
+bool MapListModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if(!index.isValid() || role != Qt::EditRole)
+        return false;
+    size_t row = static_cast<size_t>(index.row());
+    if(index.column() == 0)
+    {
+        QString path = value.toString();
+        if(!path.length())
+            return false;
+        maps.SetPath(row, path);
+    }
+    else
+    {
+        bool valid;
+        int mods = ParseMods(value.toString(), valid);
+        if(!valid) // keep the old mods
+            return false;
+        maps.SetMods(row, mods);
+    }
+    emit dataChanged(index, index);
+    return true;
+}
+
+QVariant MapListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    return section == 0 ? QString("Map") : QString("Mods");
+}
+
+Qt::ItemFlags MapListModel::flags(const QModelIndex &index) const
+{
+    if(!index.isValid())
+        return Qt::NoItemFlags;
+    return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled;
+}
@@ -0,0 +1,41 @@
+#ifndef MAPLISTMODEL_H
+#define MAPLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QItemSelection>
+#include "maplist.h"
+
+// Map list table backed by a flat MapList, selected rows are tracked in a bitmap
+class MapListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit MapListModel(QObject *parent = nullptr);
+
+    // takes over the contents of mapList, nothing is selected afterwards
+    void SetMapList(MapList &mapList);
+    const MapList &Maps() const { return maps; }
+
+    size_t SelectedCount() const;
+    MapList SelectedMaps() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+public slots:
+    // connected to QItemSelectionModel::selectionChanged of the view
+    void UpdateSelection(const QItemSelection &selected, const QItemSelection &deselected);
+
+private:
+    MapList maps;
+    std::vector<quint64> selection;
+
+    void SetSelected(size_t first, size_t last, bool selected);
+};
+
+#endif // MAPLISTMODEL_H
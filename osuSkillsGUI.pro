@@ -24,11 +24,27 @@ DEFINES += QT_DEPRECATED_WARNINGS
 CONFIG += c++11
 
 SOURCES += \
+        costmodel.cpp \
         main.cpp \
-        mainwindow.cpp
+        mainwindow.cpp \
+        maplist.cpp \
+        maplistmodel.cpp \
+        resultexport.cpp \
+        resultstore.cpp \
+        resulttablemodel.cpp \
+        skillkernels.cpp \
+        spillbuffer.cpp
 
 HEADERS += \
-        mainwindow.h
+        costmodel.h \
+        mainwindow.h \
+        maplist.h \
+        maplistmodel.h \
+        resultexport.h \
+        resultstore.h \
+        resulttablemodel.h \
+        skillkernels.h \
+        spillbuffer.h
 
 FORMS += \
         mainwindow.ui
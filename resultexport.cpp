@@ -0,0 +1,277 @@
+#include "resultexport.h"
+#include <QLocale>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+#define EXPORT_BUFFER_SIZE (1 << 20)
+#define NUM_EXPORT_COLUMNS 11
+#define NUM_TEXT_COLUMNS 2
+
+// same order as the overall table
+static const char *exportColumnNames[NUM_EXPORT_COLUMNS] = {
+    "map", "mods", "ar", "cs",
+    "stamina", "tenacity", "agility", "accuracy", "precision", "reaction", "memory"
+};
+
+// numeric columns are the stored values in the same order
+static double NumericColumn(const ResultStore &results, size_t row, int column)
+{
+    return results.Value(row, column - NUM_TEXT_COLUMNS);
+}
+
+// UTF-8, the name is not copied out of the store
+static QByteArray TextColumn(const ResultStore &results, size_t row, int column)
+{
+    if(column == 1)
+        return ModsToString(results.Mods(row)).toUtf8();
+    int length;
+    const char *name = results.NameData(row, length);
+    return QByteArray::fromRawData(name, length);
+}
+
+static quint64 Align8(quint64 size)
+{
+    return (size + 7) & ~static_cast<quint64>(7);
+}
+
+class ExportWriter
+{
+public:
+    explicit ExportWriter(QSaveFile &file) : file(file) { buffer.reserve(EXPORT_BUFFER_SIZE + 4096); }
+
+    void Append(const QByteArray &data) { buffer.append(data); FlushIfFull(); }
+    void Append(const char *data, int size) { buffer.append(data, size); FlushIfFull(); }
+    void Append(char c) { buffer.append(c); FlushIfFull(); }
+
+    // shortest representation that still round-trips to the same double, independent of the system locale
+    void AppendNumber(double val) { Append(QByteArray::number(val, 'g', QLocale::FloatingPointShortest)); }
+
+    void AppendU32(quint32 val)
+    {
+        val = qToLittleEndian(val);
+        Append(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+
+    void AppendU64(quint64 val)
+    {
+        val = qToLittleEndian(val);
+        Append(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+
+    void AppendDouble(double val)
+    {
+        quint64 bits;
+        memcpy(&bits, &val, sizeof(bits));
+        AppendU64(bits);
+    }
+
+    void Pad(quint64 size)
+    {
+        static const char zeros[8] = {};
+        Append(zeros, static_cast<int>(Align8(size) - size));
+    }
+
+    bool Flush()
+    {
+        if(buffer.size() && file.write(buffer) != buffer.size())
+            failed = true;
+        buffer.clear();
+        return !failed;
+    }
+
+private:
+    QSaveFile &file;
+    QByteArray buffer;
+    bool failed = false;
+
+    void FlushIfFull()
+    {
+        if(buffer.size() >= EXPORT_BUFFER_SIZE)
+            Flush();
+    }
+};
+
+static void AppendCsvText(ExportWriter &out, QByteArray utf8)
+{
+    out.Append('"');
+    if(utf8.contains('"'))
+        utf8.replace("\"", "\"\"");
+    out.Append(utf8);
+    out.Append('"');
+}
+
+static void AppendJsonText(ExportWriter &out, const QByteArray &utf8)
+{
+    static const char hex[] = "0123456789abcdef";
+    out.Append('"');
+    int start = 0;
+    for(int i = 0; i < utf8.size(); i++)
+    {
+        const unsigned char c = static_cast<unsigned char>(utf8[i]);
+        if(c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        out.Append(utf8.constData() + start, i - start);
+        start = i + 1;
+        if(c == '"' || c == '\\')
+        {
+            const char escaped[2] = {'\\', static_cast<char>(c)};
+            out.Append(escaped, 2);
+        }
+        else
+        {
+            const char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            out.Append(escaped, 6);
+        }
+    }
+    out.Append(utf8.constData() + start, utf8.size() - start);
+    out.Append('"');
+}
+
+static void WriteCsv(ExportWriter &out, const ResultStore &results)
+{
+    for(int column = 0; column < NUM_EXPORT_COLUMNS; column++)
+    {
+        if(column)
+            out.Append(',');
+        out.Append(exportColumnNames[column], static_cast<int>(strlen(exportColumnNames[column])));
+    }
+    out.Append('\n');
+
+    for(size_t row = 0; row < results.Size(); row++)
+    {
+        AppendCsvText(out, TextColumn(results, row, 0));
+        out.Append(',');
+        AppendCsvText(out, TextColumn(results, row, 1));
+        for(int column = NUM_TEXT_COLUMNS; column < NUM_EXPORT_COLUMNS; column++)
+        {
+            out.Append(',');
+            out.AppendNumber(NumericColumn(results, row, column));
+        }
+        out.Append('\n');
+    }
+}
+
+static void WriteJsonLines(ExportWriter &out, const ResultStore &results)
+{
+    // keys are written once, every line only appends values to them
+    QByteArray keys[NUM_EXPORT_COLUMNS];
+    for(int column = 0; column < NUM_EXPORT_COLUMNS; column++)
+        keys[column] = QByteArray(column ? ",\"" : "{\"") + exportColumnNames[column] + "\":";
+
+    for(size_t row = 0; row < results.Size(); row++)
+    {
+        for(int column = 0; column < NUM_EXPORT_COLUMNS; column++)
+        {
+            out.Append(keys[column]);
+            if(column < NUM_TEXT_COLUMNS)
+                AppendJsonText(out, TextColumn(results, row, column));
+            else
+            {
+                double val = NumericColumn(results, row, column);
+                if(std::isfinite(val))
+                    out.AppendNumber(val);
+                else
+                    out.Append("null", 4); // JSON has no NaN or infinity
+            }
+        }
+        out.Append("}\n", 2);
+    }
+}
+
+static void WriteColumnar(ExportWriter &out, const ResultStore &results)
+{
+    const quint64 rowCount = results.Size();
+
+    // string sizes are needed up front so the directory can precede the data
+    std::vector<quint64> textOffsets[NUM_TEXT_COLUMNS];
+    for(int column = 0; column < NUM_TEXT_COLUMNS; column++)
+    {
+        std::vector<quint64> &offsets = textOffsets[column];
+        offsets.resize(rowCount + 1);
+        offsets[0] = 0;
+        for(quint64 i = 0; i < rowCount; i++)
+            offsets[i + 1] = offsets[i] + static_cast<quint64>(TextColumn(results, i, column).size());
+    }
+
+    ColumnarColumn columns[NUM_EXPORT_COLUMNS];
+    quint64 offset = Align8(sizeof(ColumnarHeader) + sizeof(columns));
+    for(int column = 0; column < NUM_EXPORT_COLUMNS; column++)
+    {
+        ColumnarColumn &info = columns[column];
+        memset(&info, 0, sizeof(info));
+        strncpy(info.name, exportColumnNames[column], sizeof(info.name) - 1);
+        if(column < NUM_TEXT_COLUMNS)
+        {
+            info.type = COLUMN_UTF8;
+            info.size = (rowCount + 1) * sizeof(quint64) + textOffsets[column][rowCount];
+        }
+        else
+        {
+            info.type = COLUMN_FLOAT64;
+            info.size = rowCount * sizeof(double);
+        }
+        info.offset = offset;
+        offset += Align8(info.size);
+    }
+
+    out.Append(COLUMNAR_MAGIC, 8); // including the terminating zero
+    out.AppendU32(COLUMNAR_VERSION);
+    out.AppendU32(NUM_EXPORT_COLUMNS);
+    out.AppendU64(rowCount);
+    for(auto &info : columns)
+    {
+        out.Append(info.name, sizeof(info.name));
+        out.AppendU32(info.type);
+        out.AppendU32(info.reserved);
+        out.AppendU64(info.offset);
+        out.AppendU64(info.size);
+    }
+    out.Pad(sizeof(ColumnarHeader) + sizeof(columns));
+
+    for(int column = 0; column < NUM_EXPORT_COLUMNS; column++)
+    {
+        if(column < NUM_TEXT_COLUMNS)
+        {
+            for(quint64 textOffset : textOffsets[column])
+                out.AppendU64(textOffset);
+            for(size_t row = 0; row < results.Size(); row++)
+                out.Append(TextColumn(results, row, column));
+        }
+        else
+        {
+            for(size_t row = 0; row < results.Size(); row++)
+                out.AppendDouble(NumericColumn(results, row, column));
+        }
+        out.Pad(columns[column].size);
+    }
+}
+
+bool ExportResults(const QString &filePath, EXPORT_FORMAT format, const ResultStore &results)
+{
+    // QSaveFile only replaces the target once everything has been written
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    ExportWriter out(file);
+    switch(format)
+    {
+        case EXPORT_CSV:
+            WriteCsv(out, results);
+        break;
+        case EXPORT_JSONL:
+            WriteJsonLines(out, results);
+        break;
+        case EXPORT_COLUMNAR:
+            WriteColumnar(out, results);
+        break;
+    }
+    if(!out.Flush())
+    {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
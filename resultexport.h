@@ -0,0 +1,47 @@
+#ifndef RESULTEXPORT_H
+#define RESULTEXPORT_H
+
+#include "resultstore.h"
+
+enum EXPORT_FORMAT
+{
+    EXPORT_CSV,
+    EXPORT_JSONL,
+    EXPORT_COLUMNAR
+};
+
+// Binary columnar file layout (little-endian, every block 8-byte aligned so it can be memory-mapped):
+//   ColumnarHeader
+//   ColumnarColumn[columnCount]
+//   column data blocks
+// COLUMN_FLOAT64 block: double[rowCount]
+// COLUMN_UTF8 block: quint64 offsets[rowCount + 1] relative to the first string byte, then the string bytes
+#define COLUMNAR_MAGIC "OSKCOLS"
+#define COLUMNAR_VERSION 1
+
+enum COLUMN_TYPE
+{
+    COLUMN_FLOAT64 = 1,
+    COLUMN_UTF8 = 2
+};
+
+struct ColumnarHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 columnCount;
+    quint64 rowCount;
+};
+
+struct ColumnarColumn
+{
+    char name[16];
+    quint32 type;
+    quint32 reserved;
+    quint64 offset; // from the start of the file
+    quint64 size;   // in bytes, without padding
+};
+
+bool ExportResults(const QString &filePath, EXPORT_FORMAT format, const ResultStore &results);
+
+#endif // RESULTEXPORT_H
@@ -0,0 +1,267 @@
+#include "resultstore.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+ResultStore::ResultStore()
+{
+    SetMemoryBudget(DEFAULT_RESULT_MEMORY_BUDGET);
+}
+
+void ResultStore::SetMemoryBudget(qint64 bytes)
+{
+    records.SetMemoryBudget(bytes / 2);
+    names.SetMemoryBudget(bytes / 2);
+}
+
+void ResultStore::Clear()
+{
+    records.Clear();
+    names.Clear();
+}
+
+void ResultStore::Append(const QString &name, int mods, double ar, double cs, const Skills &skills)
+{
+    QByteArray utf8 = name.toUtf8();
+    ResultRecord record;
+    record.values[VALUE_AR] = ar;
+    record.values[VALUE_CS] = cs;
+    record.values[VALUE_SKILLS + RANKING_STAMINA] = skills.stamina;
+    record.values[VALUE_SKILLS + RANKING_TENACITY] = skills.tenacity;
+    record.values[VALUE_SKILLS + RANKING_AGILITY] = skills.agility;
+    record.values[VALUE_SKILLS + RANKING_ACCURACY] = skills.accuracy;
+    record.values[VALUE_SKILLS + RANKING_PRECISION] = skills.precision;
+    record.values[VALUE_SKILLS + RANKING_REACTION] = skills.reaction;
+    record.values[VALUE_SKILLS + RANKING_MEMORY] = skills.memory;
+    record.nameOffset = names.Append(utf8.constData(), static_cast<size_t>(utf8.size()));
+    record.nameLength = static_cast<quint32>(utf8.size());
+    record.mods = static_cast<quint16>(mods);
+    record.reserved = 0;
+    records.Append(&record, sizeof(record));
+}
+
+const char *ResultStore::NameData(size_t row, int &length) const
+{
+    const ResultRecord *record = Record(row);
+    length = static_cast<int>(record->nameLength);
+    return names.At(record->nameOffset);
+}
+
+QString ResultStore::Name(size_t row) const
+{
+    int length;
+    const char *name = NameData(row, length);
+    return QString::fromUtf8(name, length);
+}
+
+BeatmapData ResultStore::At(size_t row) const
+{
+    const ResultRecord *record = Record(row);
+    BeatmapData map;
+    map.name = Name(row);
+    map.mods = ModsToString(record->mods);
+    map.ar = record->values[VALUE_AR];
+    map.cs = record->values[VALUE_CS];
+    map.skills.stamina = record->values[VALUE_SKILLS + RANKING_STAMINA];
+    map.skills.tenacity = record->values[VALUE_SKILLS + RANKING_TENACITY];
+    map.skills.agility = record->values[VALUE_SKILLS + RANKING_AGILITY];
+    map.skills.accuracy = record->values[VALUE_SKILLS + RANKING_ACCURACY];
+    map.skills.precision = record->values[VALUE_SKILLS + RANKING_PRECISION];
+    map.skills.reaction = record->values[VALUE_SKILLS + RANKING_REACTION];
+    map.skills.memory = record->values[VALUE_SKILLS + RANKING_MEMORY];
+    return map;
+}
+
+quint64 ResultStore::Key(size_t row) const
+{
+    // FNV-1a
+    int length;
+    const char *name = NameData(row, length);
+    quint64 hash = 14695981039346656037ULL;
+    for(int i = 0; i < length; i++)
+    {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 1099511628211ULL;
+    }
+    int mods = Mods(row);
+    hash ^= static_cast<quint64>(mods & 0xFF);
+    hash *= 1099511628211ULL;
+    hash ^= static_cast<quint64>(mods >> 8);
+    hash *= 1099511628211ULL;
+    return hash;
+}
+
+bool ResultStore::SameMap(size_t row, const ResultStore &other, size_t otherRow) const
+{
+    if(Mods(row) != other.Mods(otherRow))
+        return false;
+    int length, otherLength;
+    const char *name = NameData(row, length);
+    const char *otherName = other.NameData(otherRow, otherLength);
+    return length == otherLength && !memcmp(name, otherName, static_cast<size_t>(length));
+}
+
+void RunResults::SetMemoryBudget(qint64 bytes)
+{
+    store.SetMemoryBudget(bytes / 2);
+    budget.limit = bytes / 2;
+}
+
+void RunResults::Clear()
+{
+    store.Clear();
+    for(int skill = 0; skill < NUM_SKILLS; skill++)
+    {
+        skills.values[skill].Release();
+        rankings[skill].order.Release();
+    }
+    ReleaseAggregates();
+}
+
+void RunResults::ReleaseAggregates()
+{
+    for(auto &column : deltas.values)
+        column.Release();
+    previousRows.Release();
+    overall.Release();
+}
+
+// (Key, row) of every row, sorted by key
+static const SortItem *SortedKeys(const ResultStore &store, Column<SortItem> &keys, Column<SortItem> &scratch, MemoryBudget &budget)
+{
+    size_t size = store.Size();
+    keys.Allocate(size, budget);
+    scratch.Allocate(size, budget);
+    for(size_t row = 0; row < size; row++)
+        keys[row] = std::make_pair(store.Key(row), static_cast<quint32>(row));
+    return RadixSort(keys.Data(), scratch.Data(), size);
+}
+
+// previous is only used if its derived data belongs to its current rows
+static bool UsablePrevious(const RunResults *current, const RunResults *previous)
+{
+    return previous && previous != current && previous->HasDerived();
+}
+
+void RunResults::UpdateDerived(const RunResults *previous, const double weights[NUM_SKILLS])
+{
+    size_t size = store.Size();
+
+    // the only pass over the records, everything after works on the columns
+    for(auto &column : skills.values)
+        column.Allocate(size, budget);
+    for(size_t row = 0; row < size; row++)
+    {
+        const double *values = store.SkillValues(row);
+        for(int skill = 0; skill < NUM_SKILLS; skill++)
+            skills.values[skill][row] = values[skill];
+    }
+
+    // both runs' keys are sorted, so the maps of the previous run are matched in one merge
+    previousRows.Allocate(size, budget);
+    std::fill(previousRows.Data(), previousRows.Data() + size, -1);
+    if(UsablePrevious(this, previous))
+    {
+        Column<SortItem> keys, keysScratch, previousKeys, previousKeysScratch;
+        const SortItem *sortedKeys = SortedKeys(store, keys, keysScratch, budget);
+        const SortItem *sortedPreviousKeys = SortedKeys(previous->store, previousKeys, previousKeysScratch, budget);
+        size_t previousSize = previous->store.Size();
+        size_t first = 0;
+        for(size_t k = 0; k < size; k++)
+        {
+            const SortItem &key = sortedKeys[k];
+            while(first < previousSize && sortedPreviousKeys[first].first < key.first)
+                first++;
+            for(size_t i = first; i < previousSize && sortedPreviousKeys[i].first == key.first; i++)
+            {
+                if(store.SameMap(key.second, previous->store, sortedPreviousKeys[i].second))
+                {
+                    previousRows[key.second] = static_cast<qint32>(sortedPreviousKeys[i].second);
+                    break;
+                }
+            }
+        }
+    }
+
+    // ties keep store order, the sort is stable
+    {
+        Column<SortItem> items, scratch;
+        items.Allocate(size, budget);
+        scratch.Allocate(size, budget);
+        for(int skill = 0; skill < NUM_SKILLS; skill++)
+        {
+            const Column<double> &column = skills.values[skill];
+            for(size_t row = 0; row < size; row++)
+                items[row] = std::make_pair(DescendingKey(column[row]), static_cast<quint32>(row));
+            const SortItem *sorted = RadixSort(items.Data(), scratch.Data(), size);
+            SkillRanking &ranking = rankings[skill];
+            ranking.order.Allocate(size, budget);
+            for(size_t rank = 0; rank < size; rank++)
+                ranking.order[rank] = sorted[rank].second;
+        }
+    }
+
+    bool hasPrevious = UsablePrevious(this, previous);
+    Column<double> snapshot;
+    snapshot.Allocate(size, budget);
+    for(int skill = 0; skill < NUM_SKILLS; skill++)
+    {
+        const Column<double> &column = skills.values[skill];
+        skillStats[skill] = ComputeColumnStats(column.Data(), rankings[skill].order.Data(), size);
+
+        // previous values gathered into this run's row order, then one subtraction over the column
+        for(size_t row = 0; row < size; row++)
+            snapshot[row] = hasPrevious && previousRows[row] >= 0 ? previous->skills.values[skill][static_cast<size_t>(previousRows[row])]
+                                                                  : std::numeric_limits<double>::quiet_NaN();
+        deltas.values[skill].Allocate(size, budget);
+        Deltas(column.Data(), snapshot.Data(), deltas.values[skill].Data(), size);
+    }
+    snapshot.Release();
+
+    UpdateOverall(weights);
+}
+
+void RunResults::UpdateOverall(const double weights[NUM_SKILLS])
+{
+    size_t size = store.Size();
+    Column<double> scores;
+    scores.Allocate(size, budget);
+    overall.Allocate(size, budget);
+    std::fill(overall.Data(), overall.Data() + size, 0.0);
+    double totalWeight = 0;
+    for(int skill = 0; skill < NUM_SKILLS; skill++)
+    {
+        const ColumnStats &stats = skillStats[skill];
+        // a skill that is the same for every map has no z-scores and doesn't count
+        if(stats.stddev <= 0 || weights[skill] <= 0)
+            continue;
+        ZScores(skills.values[skill].Data(), scores.Data(), size, stats.mean, stats.stddev);
+        AddScaled(scores.Data(), weights[skill], overall.Data(), size);
+        totalWeight += weights[skill];
+    }
+    if(totalWeight > 0)
+        Scale(overall.Data(), 1 / totalWeight, overall.Data(), size);
+    overallStats = ComputeColumnStats(overall.Data(), nullptr, size);
+}
+
+size_t RunResults::Rank(RANKING_TYPE skill, size_t row) const
+{
+    // the order is sorted by (DescendingKey, row), the same as the radix sort left it
+    const Column<double> &column = skills.values[skill];
+    const quint32 *order = rankings[skill].order.Data();
+    quint64 key = DescendingKey(column[row]);
+    const quint32 *position = std::lower_bound(order, order + rankings[skill].order.Size(), static_cast<quint32>(row), [&column, key](quint32 a, quint32 b)
+    {
+        quint64 keyA = DescendingKey(column[a]);
+        return keyA != key ? keyA < key : a < b;
+    });
+    return static_cast<size_t>(position - order);
+}
+
+const char *SkillName(RANKING_TYPE skill)
+{
+    static const char *names[NUM_SKILLS] = {
+        "Stamina", "Tenacity", "Agility", "Accuracy", "Precision", "Reaction", "Memory"
+    };
+    return names[skill];
+}
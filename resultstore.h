@@ -0,0 +1,102 @@
+#ifndef RESULTSTORE_H
+#define RESULTSTORE_H
+
+#include "mainwindow.h"
+#include "skillkernels.h"
+#include "spillbuffer.h"
+
+#define NUM_RESULT_VALUES (2 + NUM_SKILLS)
+
+// values kept for every map, the skills follow VALUE_SKILLS in RANKING_TYPE order
+enum RESULT_VALUE
+{
+    VALUE_AR,
+    VALUE_CS,
+    VALUE_SKILLS
+};
+
+struct ResultRecord
+{
+    double values[NUM_RESULT_VALUES];
+    quint64 nameOffset; // UTF-8 name in the name buffer
+    quint32 nameLength;
+    quint16 mods;
+    quint16 reserved;
+};
+
+// Append-only storage of calculated maps. Records have a fixed size so rows need no index,
+// records and names are kept in memory up to the budget and then in memory-mapped temporary files.
+class ResultStore
+{
+public:
+    ResultStore();
+
+    void SetMemoryBudget(qint64 bytes);
+    void Clear();
+    void Append(const QString &name, int mods, double ar, double cs, const Skills &skills);
+
+    size_t Size() const { return static_cast<size_t>(records.Size() / sizeof(ResultRecord)); }
+    QString Name(size_t row) const;
+    const char *NameData(size_t row, int &length) const;
+    int Mods(size_t row) const { return Record(row)->mods; }
+    double Value(size_t row, int value) const { return Record(row)->values[value]; }
+    double Skill(size_t row, RANKING_TYPE skill) const { return Value(row, VALUE_SKILLS + skill); }
+    const double *SkillValues(size_t row) const { return Record(row)->values + VALUE_SKILLS; }
+    BeatmapData At(size_t row) const;
+    // hash of the name and mods, the same map with the same mods has the same key in every run
+    quint64 Key(size_t row) const;
+    bool SameMap(size_t row, const ResultStore &other, size_t otherRow) const;
+
+private:
+    Q_DISABLE_COPY(ResultStore)
+    SpillBuffer records;
+    SpillBuffer names;
+
+    const ResultRecord *Record(size_t row) const { return reinterpret_cast<const ResultRecord*>(records.At(row * sizeof(ResultRecord))); }
+};
+
+// rows of one run ordered by a skill, best first, ties in store order
+struct SkillRanking
+{
+    Column<quint32> order; // rank -> row
+};
+
+// one contiguous column per skill in store row order, for the batched kernels
+struct SkillColumns
+{
+    Column<double> values[NUM_SKILLS];
+};
+
+// everything the tables show about one calculation run
+struct RunResults
+{
+    // the store and the columns get half of the budget each,
+    // mutable because the tables allocate their sort orders from it too
+    mutable MemoryBudget budget;
+    ResultStore store;
+    SkillColumns skills;
+    SkillColumns deltas;              // against the same map in the previous run, NaN for new maps
+    Column<qint32> previousRows;      // row of the same map in the previous run or -1
+    Column<double> overall;           // weighted mean of the skill z-scores
+    ColumnStats skillStats[NUM_SKILLS];
+    ColumnStats overallStats;         // without percentiles, overall is not ranked
+    SkillRanking rankings[NUM_SKILLS];
+
+    RunResults() { SetMemoryBudget(DEFAULT_RESULT_MEMORY_BUDGET / NUM_KEPT_RUNS); }
+    void SetMemoryBudget(qint64 bytes);
+    void Clear();
+    // rebuilds everything above from the store once the run is complete, previous may be null
+    void UpdateDerived(const RunResults *previous, const double weights[NUM_SKILLS]);
+    // only the overall scores, cheap enough to redo whenever the weights change
+    void UpdateOverall(const double weights[NUM_SKILLS]);
+    // once a newer run is shown only its skills and rankings are still read
+    void ReleaseAggregates();
+    bool HasDerived() const { return rankings[NUM_SKILLS - 1].order.Size() == store.Size(); }
+    bool HasAggregates() const { return HasDerived() && overall.Size() == store.Size(); }
+    // position of the row in the ranking, found from its value
+    size_t Rank(RANKING_TYPE skill, size_t row) const;
+};
+
+const char *SkillName(RANKING_TYPE skill);
+
+#endif // RESULTSTORE_H
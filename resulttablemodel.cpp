@@ -0,0 +1,278 @@
+#include "resulttablemodel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#define NUM_OVERALL_COLUMNS (5 + NUM_SKILLS)
+#define OVERALL_COMPOSITE_COLUMN (4 + NUM_SKILLS)
+#define NUM_RANKING_COLUMNS 6
+#define RANKING_CHANGE_COLUMN 5
+
+static const char *overallHeaders[NUM_OVERALL_COLUMNS] = {
+    "Map", "Mods", "AR", "CS", "Sta", "Ten", "Agi", "Acc", "Pre", "Reac", "Mem", "Overall"
+};
+
+static QString StatsText(const ColumnStats &stats, bool percentiles = true)
+{
+    QString text = QString("min %1, max %2, mean %3, stddev %4")
+            .arg(stats.min, 0, 'f', 1).arg(stats.max, 0, 'f', 1).arg(stats.mean, 0, 'f', 1).arg(stats.stddev, 0, 'f', 1);
+    if(percentiles)
+        text += QString("\np50 %1, p90 %2, p99 %3").arg(stats.p50, 0, 'f', 1).arg(stats.p90, 0, 'f', 1).arg(stats.p99, 0, 'f', 1);
+    return text;
+}
+
+ResultTableModel::ResultTableModel(RESULT_VIEW view, RANKING_TYPE skill, QObject *parent) :
+    QAbstractTableModel(parent),
+    view(view),
+    skill(skill),
+    current(nullptr),
+    previous(nullptr),
+    rowTotal(0),
+    normalized(false),
+    baseOrder(nullptr)
+{
+}
+
+size_t ResultTableModel::StoreRow(int row) const
+{
+    size_t tableRow = static_cast<size_t>(row);
+    if(sortedRows.Size())
+        return sortedRows[tableRow];
+    return baseOrder ? baseOrder[tableRow] : tableRow;
+}
+
+void ResultTableModel::SetResults(const RunResults *current, const RunResults *previous)
+{
+    beginResetModel();
+    this->current = current;
+    this->previous = previous;
+    // the store keeps growing while a run is in progress, rows are only shown up to here
+    rowTotal = current ? current->store.Size() : 0;
+    sortedRows.Release();
+    baseOrder = nullptr;
+    if(view == VIEW_RANKING && current && current->rankings[skill].order.Size() == rowTotal)
+        baseOrder = current->rankings[skill].order.Data();
+    endResetModel();
+}
+
+void ResultTableModel::SetNormalized(bool normalized)
+{
+    this->normalized = normalized;
+    if(view == VIEW_OVERALL && rowTotal)
+        emit dataChanged(index(0, 4), index(static_cast<int>(rowTotal) - 1, OVERALL_COMPOSITE_COLUMN - 1));
+}
+
+void ResultTableModel::OverallChanged()
+{
+    if(view != VIEW_OVERALL || !rowTotal)
+        return;
+    emit dataChanged(index(0, OVERALL_COMPOSITE_COLUMN), index(static_cast<int>(rowTotal) - 1, OVERALL_COMPOSITE_COLUMN));
+    emit headerDataChanged(Qt::Horizontal, OVERALL_COMPOSITE_COLUMN, OVERALL_COMPOSITE_COLUMN);
+}
+
+int ResultTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(rowTotal);
+}
+
+int ResultTableModel::columnCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+    switch(view)
+    {
+        case VIEW_OVERALL: return NUM_OVERALL_COLUMNS;
+        case VIEW_RANKING: return NUM_RANKING_COLUMNS;
+        case VIEW_MAP_NAMES: return 1;
+    }
+    return 0;
+}
+
+bool ResultTableModel::RankingChange(size_t row, int &rankChange, double &valueChange) const
+{
+    // previousRows and deltas were filled against this previous run by UpdateDerived
+    if(!previous || !current->HasAggregates() || current->previousRows[row] < 0)
+        return false;
+    size_t prevRow = static_cast<size_t>(current->previousRows[row]);
+    rankChange = static_cast<int>(previous->Rank(skill, prevRow)) - static_cast<int>(current->Rank(skill, row));
+    valueChange = current->deltas.values[skill][row];
+    return true;
+}
+
+QString ResultTableModel::RankingChangeText(size_t row) const
+{
+    int changeRank;
+    double changeVal;
+    if(!RankingChange(row, changeRank, changeVal))
+        return QString();
+    QString rankStr = (changeRank >= 0 ? "+" : "") + QString::number(abs(changeRank));
+    return "(" + QString(changeVal >= 0 ? "+" : "") + QString::number(static_cast<int>(changeVal)) + ") " + rankStr;
+}
+
+QVariant ResultTableModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || !current)
+        return QVariant();
+    if(role == Qt::ToolTipRole && view == VIEW_RANKING && index.column() == RANKING_CHANGE_COLUMN)
+        return QString("(+points) +rank");
+    if(role != Qt::DisplayRole)
+        return QVariant();
+
+    const ResultStore &store = current->store;
+    size_t row = StoreRow(index.row());
+    if(view == VIEW_MAP_NAMES)
+        return store.Name(row) + ModsToString(store.Mods(row));
+
+    switch(index.column())
+    {
+        case 0: return store.Name(row);
+        case 1: return ModsToString(store.Mods(row));
+        case 2: return QString::number(store.Value(row, VALUE_AR), 'g', 2);
+        case 3: return QString::number(store.Value(row, VALUE_CS), 'g', 2);
+    }
+    if(view == VIEW_RANKING)
+    {
+        if(index.column() == RANKING_CHANGE_COLUMN)
+            return RankingChangeText(row);
+        return static_cast<int>(store.Skill(row, skill));
+    }
+    if(index.column() == OVERALL_COMPOSITE_COLUMN)
+        return current->HasAggregates() ? QString::number(current->overall[row], 'f', 2) : QString();
+    double value = store.Value(row, VALUE_SKILLS + index.column() - 4);
+    if(normalized && current->HasDerived())
+    {
+        const ColumnStats &stats = current->skillStats[index.column() - 4];
+        return QString::number(stats.stddev > 0 ? (value - stats.mean) / stats.stddev : 0, 'f', 2);
+    }
+    return static_cast<int>(value);
+}
+
+QVariant ResultTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation != Qt::Horizontal)
+        return QVariant();
+    if(role == Qt::ToolTipRole)
+    {
+        if(!current || !current->HasAggregates() || view == VIEW_MAP_NAMES)
+            return QVariant();
+        if(view == VIEW_RANKING)
+            return section == 4 ? StatsText(current->skillStats[skill]) : QVariant();
+        if(section == OVERALL_COMPOSITE_COLUMN)
+            return "weighted mean of the skill z-scores\n" + StatsText(current->overallStats, false);
+        if(section >= 4)
+            return StatsText(current->skillStats[section - 4]);
+        return QVariant();
+    }
+    if(role != Qt::DisplayRole)
+        return QVariant();
+    if(view == VIEW_MAP_NAMES)
+        return QString("Map");
+    if(view == VIEW_RANKING)
+    {
+        if(section == 4)
+            return QString(SkillName(skill));
+        if(section == RANKING_CHANGE_COLUMN)
+            return QString("Change");
+    }
+    return QString(overallHeaders[section]);
+}
+
+double ResultTableModel::SortValue(int column, size_t row) const
+{
+    const ResultStore &store = current->store;
+    switch(column)
+    {
+        case 1: return store.Mods(row);
+        case 2: return store.Value(row, VALUE_AR);
+        case 3: return store.Value(row, VALUE_CS);
+    }
+    if(view == VIEW_RANKING && column == RANKING_CHANGE_COLUMN)
+    {
+        int rankChange;
+        double valueChange;
+        return RankingChange(row, rankChange, valueChange) ? rankChange : std::numeric_limits<double>::lowest();
+    }
+    if(view == VIEW_OVERALL && column == OVERALL_COMPOSITE_COLUMN)
+        return current->HasAggregates() ? current->overall[row] : 0;
+    int skillColumn = view == VIEW_RANKING ? skill : column - 4;
+    return current->HasDerived() ? current->skills.values[skillColumn][row] : store.Skill(row, static_cast<RANKING_TYPE>(skillColumn));
+}
+
+void ResultTableModel::sort(int column, Qt::SortOrder order)
+{
+    if(!current || view == VIEW_MAP_NAMES)
+        return;
+    const ResultStore &store = current->store;
+
+    emit layoutAboutToBeChanged();
+    QModelIndexList oldIndexes = persistentIndexList();
+    std::vector<quint32> oldStoreRows;
+    for(auto &oldIndex : oldIndexes)
+        oldStoreRows.push_back(static_cast<quint32>(StoreRow(oldIndex.row())));
+
+    if(column < 0 || (baseOrder && column == 4 && order == Qt::DescendingOrder))
+    {
+        // back to store order or the run's ranking, nothing to sort
+        sortedRows.Release();
+    }
+    else
+    {
+        // sorted from the current order, so equal keys keep it
+        if(sortedRows.Size() != rowTotal)
+        {
+            sortedRows.Allocate(rowTotal, current->budget);
+            for(size_t i = 0; i < rowTotal; i++)
+                sortedRows[i] = baseOrder ? baseOrder[i] : static_cast<quint32>(i);
+        }
+        quint32 *rows = sortedRows.Data();
+        if(column == 0)
+        {
+            // by UTF-8 bytes, no strings are built, ties by their current position
+            Column<quint32> position;
+            position.Allocate(rowTotal, current->budget);
+            for(size_t i = 0; i < rowTotal; i++)
+                position[rows[i]] = static_cast<quint32>(i);
+            std::sort(rows, rows + rowTotal, [&store, &position, order](quint32 a, quint32 b)
+            {
+                int lengthA, lengthB;
+                const char *nameA = store.NameData(a, lengthA);
+                const char *nameB = store.NameData(b, lengthB);
+                int cmp = memcmp(nameA, nameB, static_cast<size_t>(std::min(lengthA, lengthB)));
+                if(!cmp)
+                    cmp = lengthA - lengthB;
+                if(!cmp)
+                    return position[a] < position[b];
+                return order == Qt::AscendingOrder ? cmp < 0 : cmp > 0;
+            });
+        }
+        else
+        {
+            // keys are read once, the radix sort is stable
+            Column<SortItem> items, scratch;
+            items.Allocate(rowTotal, current->budget);
+            scratch.Allocate(rowTotal, current->budget);
+            for(size_t i = 0; i < rowTotal; i++)
+            {
+                quint64 key = DescendingKey(SortValue(column, rows[i]));
+                items[i] = std::make_pair(order == Qt::AscendingOrder ? ~key : key, rows[i]);
+            }
+            const SortItem *sorted = RadixSort(items.Data(), scratch.Data(), rowTotal);
+            for(size_t i = 0; i < rowTotal; i++)
+                rows[i] = sorted[i].second;
+        }
+    }
+
+    if(oldIndexes.size())
+    {
+        Column<quint32> tableRow;
+        tableRow.Allocate(rowTotal, current->budget);
+        for(size_t i = 0; i < rowTotal; i++)
+            tableRow[StoreRow(static_cast<int>(i))] = static_cast<quint32>(i);
+        QModelIndexList newIndexes;
+        for(int i = 0; i < oldIndexes.size(); i++)
+            newIndexes.append(index(static_cast<int>(tableRow[oldStoreRows[static_cast<size_t>(i)]]), oldIndexes[i].column()));
+        changePersistentIndexList(oldIndexes, newIndexes);
+    }
+    emit layoutChanged();
+}
@@ -0,0 +1,52 @@
+#ifndef RESULTTABLEMODEL_H
+#define RESULTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include "resultstore.h"
+
+enum RESULT_VIEW
+{
+    VIEW_OVERALL,
+    VIEW_RANKING,
+    VIEW_MAP_NAMES
+};
+
+// Read-only table over the results of a run, rows are read from the ResultStore on demand
+class ResultTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ResultTableModel(RESULT_VIEW view, RANKING_TYPE skill = RANKING_STAMINA, QObject *parent = nullptr);
+
+    // previous is only used for the change column of rankings
+    void SetResults(const RunResults *current, const RunResults *previous);
+    // skill columns of the overall table as z-scores instead of points
+    void SetNormalized(bool normalized);
+    // call after the run's overall scores were recalculated
+    void OverallChanged();
+    // store row shown in a table row
+    size_t StoreRow(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    RESULT_VIEW view;
+    RANKING_TYPE skill;
+    const RunResults *current;
+    const RunResults *previous;
+    size_t rowTotal;
+    bool normalized;
+    const quint32 *baseOrder;  // the run's ranking order, null while rows are in store order
+    Column<quint32> sortedRows; // set by sort, allocated from the run's budget
+
+    bool RankingChange(size_t row, int &rankChange, double &valueChange) const;
+    QString RankingChangeText(size_t row) const;
+    double SortValue(int column, size_t row) const;
+};
+
+#endif // RESULTTABLEMODEL_H
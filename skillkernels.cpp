@@ -0,0 +1,217 @@
+#include "skillkernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __SSE2__
+static double HorizontalMin(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static double HorizontalMax(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static double HorizontalSum(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+#endif
+
+static void MinMaxSum(const double *values, size_t count, double &min, double &max, double &sum)
+{
+    size_t i = 0;
+    min = values[0];
+    max = values[0];
+    sum = 0;
+#ifdef __SSE2__
+    if(count >= 4)
+    {
+        // two accumulators each to hide the add latency
+        __m128d min0 = _mm_loadu_pd(values), min1 = _mm_loadu_pd(values + 2);
+        __m128d max0 = min0, max1 = min1;
+        __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128d a = _mm_loadu_pd(values + i);
+            __m128d b = _mm_loadu_pd(values + i + 2);
+            min0 = _mm_min_pd(min0, a);
+            min1 = _mm_min_pd(min1, b);
+            max0 = _mm_max_pd(max0, a);
+            max1 = _mm_max_pd(max1, b);
+            sum0 = _mm_add_pd(sum0, a);
+            sum1 = _mm_add_pd(sum1, b);
+        }
+        min = HorizontalMin(_mm_min_pd(min0, min1));
+        max = HorizontalMax(_mm_max_pd(max0, max1));
+        sum = HorizontalSum(_mm_add_pd(sum0, sum1));
+    }
+#endif
+    for(; i < count; i++)
+    {
+        min = std::min(min, values[i]);
+        max = std::max(max, values[i]);
+        sum += values[i];
+    }
+}
+
+static double SquaredDeviationSum(const double *values, size_t count, double mean)
+{
+    size_t i = 0;
+    double sum = 0;
+#ifdef __SSE2__
+    __m128d vmean = _mm_set1_pd(mean);
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128d a = _mm_sub_pd(_mm_loadu_pd(values + i), vmean);
+        __m128d b = _mm_sub_pd(_mm_loadu_pd(values + i + 2), vmean);
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(a, a));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(b, b));
+    }
+    sum = HorizontalSum(_mm_add_pd(sum0, sum1));
+#endif
+    for(; i < count; i++)
+        sum += (values[i] - mean) * (values[i] - mean);
+    return sum;
+}
+
+ColumnStats ComputeColumnStats(const double *values, const quint32 *order, size_t count)
+{
+    ColumnStats stats;
+    if(!count)
+        return stats;
+    double sum;
+    MinMaxSum(values, count, stats.min, stats.max, sum);
+    stats.mean = sum / static_cast<double>(count);
+    // second pass around the mean, more accurate than the sum of squares
+    stats.stddev = std::sqrt(SquaredDeviationSum(values, count, stats.mean) / static_cast<double>(count));
+
+    if(!order)
+        return stats;
+    // nearest rank, counted from the lowest value
+    auto percentile = [values, order, count](double percent)
+    {
+        size_t rank = static_cast<size_t>(percent * static_cast<double>(count - 1) + 0.5);
+        return values[order[count - 1 - rank]];
+    };
+    stats.p50 = percentile(0.5);
+    stats.p90 = percentile(0.9);
+    stats.p99 = percentile(0.99);
+    return stats;
+}
+
+void ZScores(const double *values, double *out, size_t count, double mean, double stddev)
+{
+    double scale = stddev > 0 ? 1 / stddev : 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128d vmean = _mm_set1_pd(mean);
+    __m128d vscale = _mm_set1_pd(scale);
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128d a = _mm_loadu_pd(values + i);
+        __m128d b = _mm_loadu_pd(values + i + 2);
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_sub_pd(a, vmean), vscale));
+        _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_sub_pd(b, vmean), vscale));
+    }
+#endif
+    for(; i < count; i++)
+        out[i] = (values[i] - mean) * scale;
+}
+
+void Deltas(const double *values, const double *snapshot, double *out, size_t count)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for(; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(values + i), _mm_loadu_pd(snapshot + i)));
+        _mm_storeu_pd(out + i + 2, _mm_sub_pd(_mm_loadu_pd(values + i + 2), _mm_loadu_pd(snapshot + i + 2)));
+    }
+#endif
+    for(; i < count; i++)
+        out[i] = values[i] - snapshot[i];
+}
+
+void AddScaled(const double *values, double weight, double *out, size_t count)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128d vweight = _mm_set1_pd(weight);
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128d a = _mm_mul_pd(_mm_loadu_pd(values + i), vweight);
+        __m128d b = _mm_mul_pd(_mm_loadu_pd(values + i + 2), vweight);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(out + i), a));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_loadu_pd(out + i + 2), b));
+    }
+#endif
+    for(; i < count; i++)
+        out[i] += weight * values[i];
+}
+
+void Scale(const double *values, double factor, double *out, size_t count)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128d vfactor = _mm_set1_pd(factor);
+    for(; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(values + i), vfactor));
+        _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_loadu_pd(values + i + 2), vfactor));
+    }
+#endif
+    for(; i < count; i++)
+        out[i] = factor * values[i];
+}
+
+quint64 DescendingKey(double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    // flip so that unsigned order follows the value, then invert for descending
+    bits = bits >> 63 ? ~bits : bits | (static_cast<quint64>(1) << 63);
+    return ~bits;
+}
+
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES ((64 + RADIX_BITS - 1) / RADIX_BITS)
+
+SortItem *RadixSort(SortItem *items, SortItem *scratch, size_t count)
+{
+    // all histograms in one read of the keys
+    std::vector<size_t> histograms(RADIX_PASSES * RADIX_BUCKETS);
+    for(size_t i = 0; i < count; i++)
+    {
+        quint64 key = items[i].first;
+        for(int pass = 0; pass < RADIX_PASSES; pass++)
+            histograms[pass * RADIX_BUCKETS + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+    for(int pass = 0; pass < RADIX_PASSES; pass++)
+    {
+        size_t *histogram = &histograms[pass * RADIX_BUCKETS];
+        int shift = pass * RADIX_BITS;
+        // digits shared by every key, such as the exponent of similar values, need no pass
+        if(count && histogram[(items[0].first >> shift) & (RADIX_BUCKETS - 1)] == count)
+            continue;
+        size_t offset = 0;
+        for(int bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+        {
+            size_t bucketSize = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketSize;
+        }
+        for(size_t i = 0; i < count; i++)
+            scratch[histogram[(items[i].first >> shift) & (RADIX_BUCKETS - 1)]++] = items[i];
+        std::swap(items, scratch);
+    }
+    return items;
+}
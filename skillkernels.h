@@ -0,0 +1,38 @@
+#ifndef SKILLKERNELS_H
+#define SKILLKERNELS_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <utility>
+
+struct ColumnStats
+{
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double stddev = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+};
+
+typedef std::pair<quint64, quint32> SortItem; // (key, row)
+
+// Batched kernels over contiguous double columns, SSE2 where available.
+// order holds the rows sorted by descending value, without it the percentiles are left at 0
+ColumnStats ComputeColumnStats(const double *values, const quint32 *order, size_t count);
+// out = (values - mean) / stddev, out may be values
+void ZScores(const double *values, double *out, size_t count, double mean, double stddev);
+// out = values - snapshot, NaN where the snapshot is NaN
+void Deltas(const double *values, const double *snapshot, double *out, size_t count);
+// out += weight * values
+void AddScaled(const double *values, double weight, double *out, size_t count);
+// out = factor * values, out may be values
+void Scale(const double *values, double factor, double *out, size_t count);
+
+// integer key that orders doubles from the highest to the lowest
+quint64 DescendingKey(double value);
+// stable LSD radix sort by key, returns items or scratch, whichever holds the result
+SortItem *RadixSort(SortItem *items, SortItem *scratch, size_t count);
+
+#endif // SKILLKERNELS_H
@@ -0,0 +1,143 @@
+#include "spillbuffer.h"
+#include <QDir>
+#include <QTemporaryFile>
+
+SpillBuffer::SpillBuffer() :
+    tailCapacity(DEFAULT_RESULT_MEMORY_BUDGET),
+    spilledBytes(0),
+    spillFile(nullptr),
+    spillMap(nullptr),
+    spillFailed(false)
+{
+}
+
+SpillBuffer::~SpillBuffer()
+{
+    Clear();
+}
+
+void SpillBuffer::Clear()
+{
+    std::vector<char>().swap(tail);
+    if(spillFile)
+    {
+        if(spillMap)
+            spillFile->unmap(reinterpret_cast<uchar*>(const_cast<char*>(spillMap)));
+        delete spillFile; // removes the file
+    }
+    spillFile = nullptr;
+    spillMap = nullptr;
+    spilledBytes = 0;
+    spillFailed = false;
+}
+
+quint64 SpillBuffer::Append(const void *data, size_t size)
+{
+    // reserved once so the tail never reallocates, pages are only touched as it fills
+    if(tail.capacity() < tailCapacity)
+        tail.reserve(tailCapacity);
+    if(tail.size() + size > tailCapacity && !tail.empty() && !spillFailed)
+        spillFailed = !Spill(); // everything stays in memory if the disk is full
+
+    quint64 offset = Size();
+    const char *bytes = static_cast<const char*>(data);
+    tail.insert(tail.end(), bytes, bytes + size);
+    return offset;
+}
+
+bool SpillBuffer::Spill()
+{
+    if(!spillFile)
+    {
+        spillFile = new QTemporaryFile(QDir::tempPath() + "/osuSkillsGUI-results-XXXXXX");
+        if(!spillFile->open())
+        {
+            delete spillFile;
+            spillFile = nullptr;
+            return false;
+        }
+    }
+
+    qint64 size = static_cast<qint64>(tail.size());
+    if(!spillFile->seek(static_cast<qint64>(spilledBytes)) || spillFile->write(tail.data(), size) != size || !spillFile->flush())
+    {
+        spillFile->resize(static_cast<qint64>(spilledBytes));
+        return false;
+    }
+    // map the grown file before letting go of the old view so spilled data stays readable on failure
+    uchar *newMap = spillFile->map(0, static_cast<qint64>(spilledBytes) + size);
+    if(!newMap)
+    {
+        spillFile->resize(static_cast<qint64>(spilledBytes));
+        return false;
+    }
+    if(spillMap)
+        spillFile->unmap(reinterpret_cast<uchar*>(const_cast<char*>(spillMap)));
+    spillMap = reinterpret_cast<const char*>(newMap);
+    spilledBytes += static_cast<quint64>(size);
+    tail.clear(); // capacity is kept for the next appends
+    return true;
+}
+
+const char *SpillBuffer::At(quint64 offset) const
+{
+    if(offset < spilledBytes)
+        return spillMap + offset;
+    return tail.data() + (offset - spilledBytes);
+}
+
+ColumnBuffer::ColumnBuffer() :
+    data(nullptr),
+    bytes(0),
+    file(nullptr),
+    budget(nullptr)
+{
+}
+
+ColumnBuffer::~ColumnBuffer()
+{
+    Release();
+}
+
+void ColumnBuffer::Allocate(size_t bytes, MemoryBudget &budget)
+{
+    Release();
+    this->bytes = bytes;
+    if(!bytes)
+        return;
+    if(budget.used + static_cast<qint64>(bytes) > budget.limit)
+    {
+        file = new QTemporaryFile(QDir::tempPath() + "/osuSkillsGUI-column-XXXXXX");
+        uchar *map = nullptr;
+        if(file->open() && file->resize(static_cast<qint64>(bytes)))
+            map = file->map(0, static_cast<qint64>(bytes));
+        if(map)
+        {
+            data = reinterpret_cast<char*>(map);
+            return;
+        }
+        delete file;
+        file = nullptr;
+    }
+    data = new char[bytes];
+    budget.used += static_cast<qint64>(bytes);
+    this->budget = &budget;
+}
+
+void ColumnBuffer::Release()
+{
+    if(file)
+    {
+        file->unmap(reinterpret_cast<uchar*>(data));
+        delete file;
+        file = nullptr;
+    }
+    else if(data)
+    {
+        delete[] data;
+        budget->used -= static_cast<qint64>(bytes);
+        budget = nullptr;
+    }
+    data = nullptr;
+    bytes = 0;
+}
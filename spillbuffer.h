@@ -0,0 +1,96 @@
+#ifndef SPILLBUFFER_H
+#define SPILLBUFFER_H
+
+#include <QtGlobal>
+#include <vector>
+
+class QTemporaryFile;
+
+#define DEFAULT_RESULT_MEMORY_BUDGET (64 << 20) // for all kept runs together
+#define NUM_KEPT_RUNS 2 // the current run and the one it is compared to
+#define MIN_SPILL_TAIL (1 << 20) // smaller spills would remap the file too often
+
+// heap memory the buffers of one run may use together, the rest goes to temporary files
+struct MemoryBudget
+{
+    qint64 limit = DEFAULT_RESULT_MEMORY_BUDGET / NUM_KEPT_RUNS;
+    qint64 used = 0;
+};
+
+// Append-only bytes. Appends go to an in-memory tail that is reserved once, a full tail is
+// moved to a temporary file that is read back through a memory map.
+class SpillBuffer
+{
+public:
+    SpillBuffer();
+    ~SpillBuffer();
+
+    // size of the tail, takes effect when the buffer is empty
+    void SetMemoryBudget(qint64 bytes) { tailCapacity = static_cast<size_t>(qMax(bytes, static_cast<qint64>(MIN_SPILL_TAIL))); }
+    void Clear();
+    // offset of the data, pointers from At stay valid until the next Append
+    quint64 Append(const void *data, size_t size);
+    quint64 Size() const { return spilledBytes + tail.size(); }
+    const char *At(quint64 offset) const;
+
+private:
+    Q_DISABLE_COPY(SpillBuffer)
+    size_t tailCapacity;
+    std::vector<char> tail; // data that is not spilled yet
+    quint64 spilledBytes;
+    QTemporaryFile *spillFile;
+    const char *spillMap;
+    bool spillFailed;
+
+    bool Spill();
+};
+
+// Fixed-size block that stays on the heap while it fits the budget, otherwise it gets
+// its own memory-mapped temporary file. Falls back to the heap if the file can't be made.
+class ColumnBuffer
+{
+public:
+    ColumnBuffer();
+    ~ColumnBuffer();
+
+    // contents are undefined
+    void Allocate(size_t bytes, MemoryBudget &budget);
+    void Release();
+    size_t Bytes() const { return bytes; }
+    char *Data() { return data; }
+    const char *Data() const { return data; }
+
+private:
+    Q_DISABLE_COPY(ColumnBuffer)
+    char *data;
+    size_t bytes;
+    QTemporaryFile *file;
+    MemoryBudget *budget; // set while data is on the heap
+};
+
+template<class T>
+class Column
+{
+public:
+    void Allocate(size_t count, MemoryBudget &budget)
+    {
+        buffer.Allocate(count * sizeof(T), budget);
+        this->count = count;
+    }
+    void Release()
+    {
+        buffer.Release();
+        count = 0;
+    }
+    size_t Size() const { return count; }
+    T *Data() { return reinterpret_cast<T*>(buffer.Data()); }
+    const T *Data() const { return reinterpret_cast<const T*>(buffer.Data()); }
+    T &operator[](size_t i) { return Data()[i]; }
+    const T &operator[](size_t i) const { return Data()[i]; }
+
+private:
+    ColumnBuffer buffer;
+    size_t count = 0;
+};
+
+#endif // SPILLBUFFER_H